@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -41,6 +41,9 @@ struct entry_point_info *bl2_load_images(void)
 	assert(bl2_load_info->h.version >= VERSION_2);
 	bl2_node_info = bl2_load_info->head;
 
+	/* Keep device connections open across all the images loaded below */
+	bl_io_session_begin();
+
 	while (bl2_node_info != NULL) {
 		/*
 		 * Perform platform setup before loading the image,
@@ -89,6 +92,14 @@ struct entry_point_info *bl2_load_images(void)
 		bl2_node_info = bl2_node_info->next_load_info;
 	}
 
+	/* All images are loaded, release the device connections */
+	bl_io_session_end();
+
+#if TRUSTED_BOARD_BOOT
+	INFO("BL2: %u parent image verification(s) saved by the auth cache\n",
+	     auth_mod_get_cache_hits());
+#endif
+
 	/*
 	 * Get information to pass to the next image.
 	 */
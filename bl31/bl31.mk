@@ -48,6 +48,18 @@ ifeq (${ENABLE_PMF}, 1)
 BL31_SOURCES		+=	lib/pmf/pmf_main.c
 endif
 
+ifeq (${ENABLE_RT_SVC_HISTOGRAMS},1)
+BL31_SOURCES		+=	lib/pmf/pmf_rt_svc_hist.c
+endif
+
+ifneq ($(filter 1,${ENABLE_RT_SVC_HISTOGRAMS} ${PSCI_STAT_SNAPSHOT}),)
+BL31_SOURCES		+=	lib/pmf/pmf_ns_buf.c
+endif
+
+ifeq (${ZERO_MEM_BENCHMARK},1)
+BL31_SOURCES		+=	lib/utils/zero_mem_bench.c
+endif
+
 include lib/debugfs/debugfs.mk
 ifeq (${USE_DEBUGFS},1)
 	BL31_SOURCES	+= $(DEBUGFS_SRCS)
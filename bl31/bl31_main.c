@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -19,6 +19,7 @@
 #include <lib/el3_runtime/context_mgmt.h>
 #include <lib/pmf/pmf.h>
 #include <lib/runtime_instr.h>
+#include <lib/utils.h>
 #include <plat/common/platform.h>
 #include <services/std_svc.h>
 
@@ -116,6 +117,14 @@ void bl31_main(void)
 	/* Perform platform setup in BL31 */
 	bl31_platform_setup();
 
+#if ZERO_MEM_BENCHMARK
+	zero_mem_benchmark();
+#endif
+
+#if CTX_SYSREGS_BENCHMARK
+	cm_sysregs_benchmark();
+#endif
+
 	/* Initialise helper libraries */
 	bl31_lib_init();
 
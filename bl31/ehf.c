@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -11,16 +11,20 @@
 #include <assert.h>
 #include <stdbool.h>
 
+#include <arch_helpers.h>
 #include <bl31/ehf.h>
 #include <bl31/interrupt_mgmt.h>
 #include <context.h>
 #include <common/debug.h>
 #include <drivers/arm/gic_common.h>
+#include <lib/cassert.h>
 #include <lib/el3_runtime/context_mgmt.h>
 #include <lib/el3_runtime/cpu_data.h>
 #include <lib/el3_runtime/pubsub_events.h>
 #include <plat/common/platform.h>
 
+#include <platform_def.h>
+
 /* Output EHF logs as verbose */
 #define EHF_LOG(...)	VERBOSE("EHF: " __VA_ARGS__)
 
@@ -50,6 +54,49 @@
 /* To be defined by the platform */
 extern const ehf_priorities_t exception_data;
 
+#if EHF_TRACE
+/*
+ * Each CPU only records events in its own trace buffer, so no lock is needed.
+ * A reader on another CPU may see the event being recorded half written.
+ */
+static ehf_trace_cpu_t ehf_trace[PLATFORM_CORE_COUNT];
+
+CASSERT((EHF_TRACE_ENTRIES & (EHF_TRACE_ENTRIES - 1U)) == 0U,
+	assert_ehf_trace_entries_not_power_of_2);
+
+static void ehf_trace_record(unsigned int event, unsigned int pri,
+			     int prev_idx, uint32_t intr_raw)
+{
+	ehf_trace_cpu_t *trace = &ehf_trace[plat_my_core_pos()];
+	ehf_trace_entry_t *entry;
+
+	entry = &trace->entries[trace->count & (EHF_TRACE_ENTRIES - 1U)];
+	entry->timestamp = read_cntpct_el0();
+	entry->intr_raw = intr_raw;
+	entry->event = (uint8_t)event;
+	entry->priority = (uint8_t)pri;
+	entry->prev_priority = (prev_idx == EHF_INVALID_IDX) ?
+		(uint8_t)EHF_TRACE_NO_PRI : (uint8_t)IDX_TO_PRI(prev_idx);
+	trace->count++;
+}
+
+/*
+ * Return the trace buffers of all the CPUs, in core position order, and their
+ * total size in 'size'.
+ */
+const ehf_trace_cpu_t *ehf_trace_get(size_t *size)
+{
+	*size = sizeof(ehf_trace);
+
+	return ehf_trace;
+}
+#else
+static inline void ehf_trace_record(unsigned int event, unsigned int pri,
+				    int prev_idx, uint32_t intr_raw)
+{
+}
+#endif /* EHF_TRACE */
+
 /* Translate priority to the index in the priority array */
 static unsigned int pri_to_idx(unsigned int priority)
 {
@@ -150,6 +197,8 @@ void ehf_activate_priority(unsigned int priority)
 	if (cur_pri_idx == EHF_INVALID_IDX)
 		pe_data->init_pri_mask = (uint8_t) old_mask;
 
+	ehf_trace_record(EHF_TRACE_ACTIVATE, priority, cur_pri_idx, 0U);
+
 	EHF_LOG("activate prio=%d\n", get_pe_highest_active_idx(pe_data));
 }
 
@@ -198,6 +247,8 @@ void ehf_deactivate_priority(unsigned int priority)
 	/* Clear bit corresponding to highest priority */
 	pe_data->active_pri_bits &= (pe_data->active_pri_bits - 1u);
 
+	ehf_trace_record(EHF_TRACE_DEACTIVATE, priority, cur_pri_idx, 0U);
+
 	/*
 	 * Restore priority mask corresponding to the next priority, or the
 	 * one stashed earlier if there are no more to deactivate.
@@ -432,6 +483,9 @@ static uint64_t ehf_el3_interrupt_handler(uint32_t id, uint32_t flags,
 	/* Validate priority */
 	assert(pri == IDX_TO_PRI(idx));
 
+	ehf_trace_record(EHF_TRACE_PREEMPT, pri,
+			 get_pe_highest_active_idx(this_cpu_data()), intr_raw);
+
 	handler = (ehf_handler_t) RAW_HANDLER(
 			exception_data.ehf_priorities[idx].ehf_handler);
 	if (handler == NULL) {
@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2016-2020, ARM Limited and Contributors. All rights reserved.
+# Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -27,6 +27,14 @@ ifeq (${ENABLE_PMF}, 1)
 BL32_SOURCES		+=	lib/pmf/pmf_main.c
 endif
 
+ifeq (${ENABLE_RT_SVC_HISTOGRAMS},1)
+BL32_SOURCES		+=	lib/pmf/pmf_rt_svc_hist.c
+endif
+
+ifneq ($(filter 1,${ENABLE_RT_SVC_HISTOGRAMS} ${PSCI_STAT_SNAPSHOT}),)
+BL32_SOURCES		+=	lib/pmf/pmf_ns_buf.c
+endif
+
 ifeq (${ENABLE_AMU}, 1)
 BL32_SOURCES		+=	lib/extensions/amu/aarch32/amu.c\
 				lib/extensions/amu/aarch32/amu_helpers.S
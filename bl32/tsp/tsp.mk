@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2013-2019, ARM Limited and Contributors. All rights reserved.
+# Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -15,6 +15,10 @@ BL32_SOURCES		+=	bl32/tsp/tsp_main.c			\
 				common/aarch64/early_exceptions.S	\
 				lib/locks/exclusive/aarch64/spinlock.S
 
+ifeq (${SPINLOCK_STATS},1)
+BL32_SOURCES		+=	lib/locks/exclusive/spinlock_stats.c
+endif
+
 BL32_LINKERFILE		:=	bl32/tsp/tsp.ld.S
 
 # This flag determines if the TSPD initializes BL32 in tspd_init() (synchronous
@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include <arch.h>
@@ -13,6 +14,7 @@
 #include <arch_helpers.h>
 #include <common/bl_common.h>
 #include <common/debug.h>
+#include <common/image_decompress.h>
 #include <drivers/auth/auth_mod.h>
 #include <drivers/io/io_storage.h>
 #include <lib/utils.h>
@@ -47,6 +49,155 @@ static int dyn_is_auth_disabled(void)
 }
 #endif /* TRUSTED_BOARD_BOOT */
 
+/*
+ * Maximum number of distinct device connections an I/O session keeps open.
+ * Devices beyond this limit are closed after each image as usual.
+ */
+#define IO_SESSION_MAX_DEVICES	4U
+
+/*
+ * State of the I/O session. While a session is active, load_image() does not
+ * close the device it used so that subsequent images loaded by the same
+ * boot stage reuse the connection (and whatever the driver cached on it,
+ * e.g. a validated FIP header and ToC).
+ */
+static bool io_session_active;
+static uintptr_t io_session_devs[IO_SESSION_MAX_DEVICES];
+static unsigned int io_session_dev_count;
+static unsigned int io_session_reuse_count;
+
+/*******************************************************************************
+ * Start an I/O session. Device connections used by load_image() from now on
+ * are kept open until bl_io_session_end() is called.
+ ******************************************************************************/
+void bl_io_session_begin(void)
+{
+	assert(!io_session_active);
+
+	io_session_dev_count = 0U;
+	io_session_reuse_count = 0U;
+	io_session_active = true;
+}
+
+/*******************************************************************************
+ * End the I/O session, closing every device connection it kept open. This is
+ * meant to be called once, before handing off to the next image.
+ ******************************************************************************/
+void bl_io_session_end(void)
+{
+	unsigned int i;
+
+	if (!io_session_active) {
+		return;
+	}
+
+	for (i = 0U; i < io_session_dev_count; i++) {
+		/* Ignore improbable/unrecoverable error in 'dev_close' */
+		(void)io_dev_close(io_session_devs[i]);
+	}
+
+	INFO("I/O session: %u device(s) kept open, %u reconnection(s) saved\n",
+	     io_session_dev_count, io_session_reuse_count);
+
+	io_session_dev_count = 0U;
+	io_session_active = false;
+}
+
+/*
+ * Release a device connection used by load_image(). Within an I/O session
+ * the connection is recorded and left open, otherwise it is closed.
+ */
+static void io_session_release_dev(uintptr_t dev_handle)
+{
+	unsigned int i;
+
+	if (io_session_active) {
+		for (i = 0U; i < io_session_dev_count; i++) {
+			if (io_session_devs[i] == dev_handle) {
+				io_session_reuse_count++;
+				return;
+			}
+		}
+
+		if (io_session_dev_count < IO_SESSION_MAX_DEVICES) {
+			io_session_devs[io_session_dev_count] = dev_handle;
+			io_session_dev_count++;
+			return;
+		}
+	}
+
+	/* Ignore improbable/unrecoverable error in 'dev_close' */
+	(void)io_dev_close(dev_handle);
+}
+
+#if STREAM_HASH_AUTH
+/*
+ * Size of the chunks in which an image is read when it is hashed while being
+ * loaded. Each chunk is hashed right after it lands, while it is still hot in
+ * the data cache.
+ */
+#ifndef STREAM_HASH_CHUNK_SIZE
+#define STREAM_HASH_CHUNK_SIZE	U(0x8000)
+#endif
+
+/*
+ * Read an image in chunks, handing each chunk to the authentication module so
+ * that the image hash is ready by the time the last byte is read.
+ */
+static int read_image_stream_hash(uintptr_t image_handle, uintptr_t image_base,
+				  size_t image_size, size_t *bytes_read)
+{
+	size_t offset = 0U;
+	size_t chunk, chunk_read;
+	int io_result = 0;
+
+	while (offset < image_size) {
+		chunk = MIN(image_size - offset, (size_t)STREAM_HASH_CHUNK_SIZE);
+
+		io_result = io_read(image_handle, image_base + offset, chunk,
+				    &chunk_read);
+		if (io_result != 0) {
+			break;
+		}
+
+		auth_mod_stream_hash_update((void *)(image_base + offset),
+					    (unsigned int)chunk_read);
+		offset += chunk_read;
+
+		if (chunk_read < chunk) {
+			break;
+		}
+	}
+
+	*bytes_read = offset;
+
+	return io_result;
+}
+#endif /* STREAM_HASH_AUTH */
+
+/*
+ * Read the whole image to 'image_base', or hand it to the decompressor when
+ * the platform has asked for it to be decompressed while it is loaded.
+ */
+static int read_image(unsigned int image_id, uintptr_t image_handle,
+		      uintptr_t image_base, size_t image_size,
+		      size_t *bytes_read)
+{
+#if IMAGE_DECOMPRESS_STREAM
+	if (image_decompress_stream_pending(image_id)) {
+		return image_decompress_stream_read(image_handle, image_size,
+						    bytes_read);
+	}
+#endif
+
+#if STREAM_HASH_AUTH
+	return read_image_stream_hash(image_handle, image_base, image_size,
+				      bytes_read);
+#else
+	return io_read(image_handle, image_base, image_size, bytes_read);
+#endif
+}
+
 uintptr_t page_align(uintptr_t value, unsigned dir)
 {
 	/* Round up the limit to the next page boundary */
@@ -123,7 +274,8 @@ static int load_image(unsigned int image_id, image_info_t *image_data)
 
 	/* We have enough space so load the image now */
 	/* TODO: Consider whether to try to recover/retry a partially successful read */
-	io_result = io_read(image_handle, image_base, image_size, &bytes_read);
+	io_result = read_image(image_id, image_handle, image_base, image_size,
+			       &bytes_read);
 	if ((io_result != 0) || (bytes_read < image_size)) {
 		WARN("Failed to load image id=%u (%i)\n", image_id, io_result);
 		goto exit;
@@ -136,9 +288,7 @@ exit:
 	(void)io_close(image_handle);
 	/* Ignore improbable/unrecoverable error in 'close' */
 
-	/* TODO: Consider maintaining open device connection from this bootloader stage */
-	(void)io_dev_close(dev_handle);
-	/* Ignore improbable/unrecoverable error in 'dev_close' */
+	io_session_release_dev(dev_handle);
 
 	return io_result;
 }
@@ -183,6 +333,14 @@ static int load_auth_image_recursive(unsigned int image_id,
 		}
 	}
 
+#if STREAM_HASH_AUTH
+	/*
+	 * Hash the image while it is loaded if the authentication module can
+	 * do so. Otherwise it is hashed by auth_mod_verify_img() as usual.
+	 */
+	(void)auth_mod_stream_hash_begin(image_id);
+#endif
+
 	/* Load the image */
 	rc = load_image(image_id, image_data);
 	if (rc != 0) {
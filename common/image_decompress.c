@@ -1,22 +1,44 @@
 /*
- * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2018-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <errno.h>
 #include <stdint.h>
 
 #include <arch_helpers.h>
 #include <common/bl_common.h>
 #include <common/debug.h>
 #include <common/image_decompress.h>
+#include <drivers/io/io_storage.h>
+#include <lib/utils.h>
+#include <lib/utils_def.h>
 
 static uintptr_t decompressor_buf_base;
 static uint32_t decompressor_buf_size;
 static decompressor_t *decompressor;
 static struct image_info saved_image_info;
 
+#if IMAGE_DECOMPRESS_STREAM
+/*
+ * Size of the chunks in which a compressed image is read when it is
+ * decompressed while being loaded. The chunks are staged at the start of the
+ * temporary buffer and the rest of it is the workspace of the decompressor,
+ * so the buffer does not depend on the size of the image.
+ */
+#ifndef IMAGE_DECOMPRESS_CHUNK_SIZE
+#define IMAGE_DECOMPRESS_CHUNK_SIZE	U(0x8000)
+#endif
+
+static const decompressor_stream_t *stream_decompressor;
+static unsigned int stream_image_id;
+static bool stream_pending;
+static bool stream_done;
+static uintptr_t stream_out_end;
+#endif /* IMAGE_DECOMPRESS_STREAM */
+
 void image_decompress_init(uintptr_t buf_base, uint32_t buf_size,
 			   decompressor_t *_decompressor)
 {
@@ -44,6 +66,27 @@ int image_decompress(struct image_info *info)
 	uint32_t compressed_image_size, work_size;
 	int ret;
 
+#if IMAGE_DECOMPRESS_STREAM
+	if (stream_decompressor != NULL) {
+		if (!stream_done) {
+			ERROR("Image was not decompressed while loaded\n");
+			return -EINVAL;
+		}
+
+		/* The image was decompressed while it was loaded */
+		stream_pending = false;
+		stream_done = false;
+		*info = saved_image_info;
+		info->image_size = stream_out_end - info->image_base;
+
+		flush_dcache_range(info->image_base, info->image_size);
+
+		return 0;
+	}
+#endif
+
+	assert(decompressor != NULL);
+
 	/*
 	 * The size of compressed data has been filled by load_image().
 	 * Read it out before restoring image_info.
@@ -78,3 +121,128 @@ int image_decompress(struct image_info *info)
 
 	return 0;
 }
+
+#if IMAGE_DECOMPRESS_STREAM
+void image_decompress_stream_init(uintptr_t buf_base, uint32_t buf_size,
+				  const decompressor_stream_t *_decompressor)
+{
+	assert(_decompressor != NULL);
+	assert(buf_size > IMAGE_DECOMPRESS_CHUNK_SIZE);
+
+	decompressor_buf_base = buf_base;
+	decompressor_buf_size = buf_size;
+	stream_decompressor = _decompressor;
+}
+
+/*
+ * Arrange for the image 'image_id' to be decompressed to its destination
+ * while load_image() reads it, instead of being loaded to the temporary
+ * buffer and decompressed afterwards. The image stays armed until
+ * image_decompress() has consumed it, so that load_auth_image() can retry it
+ * from another boot source.
+ */
+void image_decompress_prepare_stream(unsigned int image_id,
+				     struct image_info *info)
+{
+	assert(stream_decompressor != NULL);
+
+	saved_image_info = *info;
+	stream_image_id = image_id;
+	stream_pending = true;
+	stream_done = false;
+}
+
+bool image_decompress_stream_pending(unsigned int image_id)
+{
+	return stream_pending && (stream_image_id == image_id);
+}
+
+/*
+ * Wipe the output of the image 'image_id' after it has failed to load. The
+ * decompressed data may be much larger than the compressed image, so the
+ * whole destination is cleared.
+ */
+void image_decompress_stream_abort(unsigned int image_id)
+{
+	if (!image_decompress_stream_pending(image_id)) {
+		return;
+	}
+
+	stream_done = false;
+
+	zero_normalmem((void *)saved_image_info.image_base,
+		       saved_image_info.image_max_size);
+	flush_dcache_range(saved_image_info.image_base,
+			   saved_image_info.image_max_size);
+}
+
+/*
+ * Read 'image_size' bytes of compressed data from 'image_handle' one chunk at
+ * a time and feed each chunk to the decompressor. The number of compressed
+ * bytes read is returned in 'bytes_read', as io_read() would.
+ */
+int image_decompress_stream_read(uintptr_t image_handle, size_t image_size,
+				 size_t *bytes_read)
+{
+	uintptr_t chunk_base = decompressor_buf_base;
+	uintptr_t work_base = chunk_base + IMAGE_DECOMPRESS_CHUNK_SIZE;
+	size_t work_size = decompressor_buf_size - IMAGE_DECOMPRESS_CHUNK_SIZE;
+	size_t offset = 0U;
+	size_t chunk, chunk_read;
+	int ret;
+
+	assert(stream_pending);
+	stream_done = false;
+
+	ret = stream_decompressor->init(saved_image_info.image_base,
+					saved_image_info.image_max_size,
+					work_base, work_size);
+	if (ret != 0) {
+		*bytes_read = 0U;
+		return ret;
+	}
+
+	while (offset < image_size) {
+		chunk = MIN(image_size - offset,
+			    (size_t)IMAGE_DECOMPRESS_CHUNK_SIZE);
+
+		ret = io_read(image_handle, chunk_base, chunk, &chunk_read);
+		if (ret != 0) {
+			break;
+		}
+
+		ret = stream_decompressor->update(chunk_base, chunk_read);
+		if (ret != 0) {
+			ERROR("Failed to decompress image (err=%d)\n", ret);
+			break;
+		}
+
+		offset += chunk_read;
+
+		if (chunk_read < chunk) {
+			break;
+		}
+	}
+
+	*bytes_read = offset;
+
+	if ((ret == 0) && (offset == image_size)) {
+		ret = stream_decompressor->finish(&stream_out_end);
+		if (ret != 0) {
+			ERROR("Failed to decompress image (err=%d)\n", ret);
+		}
+	} else if (ret == 0) {
+		/* Short read, reported through 'bytes_read' */
+		ret = -EIO;
+	}
+
+	if (ret != 0) {
+		image_decompress_stream_abort(stream_image_id);
+		return ret;
+	}
+
+	stream_done = true;
+
+	return 0;
+}
+#endif /* IMAGE_DECOMPRESS_STREAM */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,8 +8,10 @@
 #include <errno.h>
 #include <string.h>
 
+#include <arch_helpers.h>
 #include <common/debug.h>
 #include <common/runtime_svc.h>
+#include <lib/pmf/pmf_rt_svc_hist.h>
 
 /*******************************************************************************
  * The 'rt_svc_descs' array holds the runtime service descriptors exported by
@@ -38,6 +40,10 @@ uintptr_t handle_runtime_svc(uint32_t smc_fid,
 	unsigned int index;
 	unsigned int idx;
 	const rt_svc_desc_t *rt_svc_descs;
+#if ENABLE_RT_SVC_HISTOGRAMS
+	uint64_t start = read_cntpct_el0();
+	uintptr_t ret;
+#endif
 
 	assert(handle != NULL);
 	idx = get_unique_oen_from_smc_fid(smc_fid);
@@ -51,8 +57,16 @@ uintptr_t handle_runtime_svc(uint32_t smc_fid,
 
 	get_smc_params_from_ctx(handle, x1, x2, x3, x4);
 
+#if ENABLE_RT_SVC_HISTOGRAMS
+	ret = rt_svc_descs[index].handle(smc_fid, x1, x2, x3, x4, cookie,
+						handle, flags);
+	pmf_rt_svc_hist_record(smc_fid, start);
+
+	return ret;
+#else
 	return rt_svc_descs[index].handle(smc_fid, x1, x2, x3, x4, cookie,
 						handle, flags);
+#endif
 }
 
 /*******************************************************************************
@@ -44,52 +44,170 @@ static bool is_sgi_ppi(unsigned int id);
 #define SAVE_GICR_REG(base, ctx, name, i)	\
 	(ctx)->gicr_##name[(i)] = gicr_read_##name((base), (i))
 
-/* Helper macros to save and restore GICD registers to and from the context */
-#define RESTORE_GICD_REGS(base, ctx, intr_num, reg, REG)		\
+/*
+ * The set-enable, set-pending and set-active registers are write-1-to-set, so
+ * restoring a zero value is a no-op and is skipped.
+ */
+#define RESTORE_GICR_W1S_REG(base, ctx, name, i)			\
 	do {								\
-		for (unsigned int int_id = MIN_SPI_ID; int_id < (intr_num);\
-				int_id += (1U << REG##R_SHIFT)) {	\
-			gicd_write_##reg((base), int_id,		\
-				(ctx)->gicd_##reg[(int_id - MIN_SPI_ID) >> \
-							REG##R_SHIFT]);	\
+		if ((ctx)->gicr_##name[(i)] != 0U) {			\
+			RESTORE_GICR_REG(base, ctx, name, i);		\
 		}							\
 	} while (false)
 
-#define SAVE_GICD_REGS(base, ctx, intr_num, reg, REG)			\
+/*
+ * Blocks of 32 SPIs and ESPIs that the platform marks as unused. Their GICD
+ * registers are neither saved nor restored.
+ */
+static uint32_t gicv3_unused_spis;
+#if GIC_EXT_INTID
+static uint32_t gicv3_unused_espis;
+#endif
+
+#define GICD_BLOCK_UNUSED(unused, blk_base, id)				\
+	(((unused) & (U(1) << (((id) - (blk_base)) >> 5))) != 0U)
+
+/*
+ * Helper macros to save and restore the GICD registers of the INTIDs from
+ * 'min_id' up to 'intr_num' to and from the context. The registers are
+ * accessed directly with 'RD' and 'WR', the blocks of 32 INTIDs marked in
+ * 'unused' are skipped and, if 'w1s' is set, zero values are not restored.
+ * 'ctx_base' is the INTID that would be held by the first register of the
+ * context array.
+ */
+#define SAVE_GICD_RANGE(base, ctx, min_id, intr_num, reg, REG, RD,	\
+			ctx_base, unused, blk_base)			\
 	do {								\
-		for (unsigned int int_id = MIN_SPI_ID; int_id < (intr_num);\
+		for (unsigned int int_id = (min_id); int_id < (intr_num);\
 				int_id += (1U << REG##R_SHIFT)) {	\
-			(ctx)->gicd_##reg[(int_id - MIN_SPI_ID) >>	\
-			REG##R_SHIFT] = gicd_read_##reg((base), int_id); \
+			if (GICD_BLOCK_UNUSED(unused, blk_base, int_id)) {\
+				continue;				\
+			}						\
+			(ctx)->gicd_##reg[(int_id - (ctx_base)) >>	\
+				REG##R_SHIFT] = RD(REG, (base), int_id);\
 		}							\
 	} while (false)
 
-#if GIC_EXT_INTID
-#define RESTORE_GICD_EREGS(base, ctx, intr_num, reg, REG)		\
+#define RESTORE_GICD_RANGE(base, ctx, min_id, intr_num, reg, REG, WR,	\
+			   ctx_base, unused, blk_base, w1s)		\
 	do {								\
-		for (unsigned int int_id = MIN_ESPI_ID; int_id < (intr_num);\
+		for (unsigned int int_id = (min_id); int_id < (intr_num);\
 				int_id += (1U << REG##R_SHIFT)) {	\
-			gicd_write_##reg((base), int_id,		\
-			(ctx)->gicd_##reg[(int_id - (MIN_ESPI_ID -	\
-			round_up(TOTAL_SPI_INTR_NUM, 1U << REG##R_SHIFT)))\
-						>> REG##R_SHIFT]);	\
+			if (GICD_BLOCK_UNUSED(unused, blk_base, int_id)) {\
+				continue;				\
+			}						\
+			if ((w1s) && ((ctx)->gicd_##reg[(int_id -	\
+				(ctx_base)) >> REG##R_SHIFT] == 0U)) {	\
+				continue;				\
+			}						\
+			WR(REG, (base), int_id, (ctx)->gicd_##reg[	\
+				(int_id - (ctx_base)) >> REG##R_SHIFT]);\
 		}							\
 	} while (false)
 
+/* Helper macros to save and restore GICD registers to and from the context */
+#define SAVE_GICD_REGS(base, ctx, intr_num, reg, REG)			\
+	SAVE_GICD_RANGE(base, ctx, MIN_SPI_ID, intr_num, reg, REG,	\
+			GICD_READ, MIN_SPI_ID, gicv3_unused_spis, 0U)
+
+#define RESTORE_GICD_REGS(base, ctx, intr_num, reg, REG, w1s)		\
+	RESTORE_GICD_RANGE(base, ctx, MIN_SPI_ID, intr_num, reg, REG,	\
+			   GICD_WRITE, MIN_SPI_ID, gicv3_unused_spis, 0U,\
+			   w1s)
+
+#define SAVE_GICD_REGS_64(base, ctx, intr_num, reg, REG)		\
+	SAVE_GICD_RANGE(base, ctx, MIN_SPI_ID, intr_num, reg, REG,	\
+			GICD_READ_64, MIN_SPI_ID, gicv3_unused_spis, 0U)
+
+#define RESTORE_GICD_REGS_64(base, ctx, intr_num, reg, REG)		\
+	RESTORE_GICD_RANGE(base, ctx, MIN_SPI_ID, intr_num, reg, REG,	\
+			   GICD_WRITE_64, MIN_SPI_ID, gicv3_unused_spis,\
+			   0U, false)
+
+#if GIC_EXT_INTID
+#define GICD_ECTX_BASE(REG)						\
+	(MIN_ESPI_ID - round_up(TOTAL_SPI_INTR_NUM, 1U << REG##R_SHIFT))
+
 #define SAVE_GICD_EREGS(base, ctx, intr_num, reg, REG)			\
-	do {								\
-		for (unsigned int int_id = MIN_ESPI_ID; int_id < (intr_num);\
-				int_id += (1U << REG##R_SHIFT)) {	\
-			(ctx)->gicd_##reg[(int_id - (MIN_ESPI_ID -	\
-			round_up(TOTAL_SPI_INTR_NUM, 1U << REG##R_SHIFT)))\
-			>> REG##R_SHIFT] = gicd_read_##reg((base), int_id);\
-		}							\
-	} while (false)
+	SAVE_GICD_RANGE(base, ctx, MIN_ESPI_ID, intr_num, reg, REG,	\
+			GICD_READ, GICD_ECTX_BASE(REG),			\
+			gicv3_unused_espis, MIN_ESPI_ID)
+
+#define RESTORE_GICD_EREGS(base, ctx, intr_num, reg, REG, w1s)		\
+	RESTORE_GICD_RANGE(base, ctx, MIN_ESPI_ID, intr_num, reg, REG,	\
+			   GICD_WRITE, GICD_ECTX_BASE(REG),		\
+			   gicv3_unused_espis, MIN_ESPI_ID, w1s)
+
+#define SAVE_GICD_EREGS_64(base, ctx, intr_num, reg, REG)		\
+	SAVE_GICD_RANGE(base, ctx, MIN_ESPI_ID, intr_num, reg, REG,	\
+			GICD_READ_64, GICD_ECTX_BASE(REG),		\
+			gicv3_unused_espis, MIN_ESPI_ID)
+
+#define RESTORE_GICD_EREGS_64(base, ctx, intr_num, reg, REG)		\
+	RESTORE_GICD_RANGE(base, ctx, MIN_ESPI_ID, intr_num, reg, REG,	\
+			   GICD_WRITE_64, GICD_ECTX_BASE(REG),		\
+			   gicv3_unused_espis, MIN_ESPI_ID, false)
 #else
 #define SAVE_GICD_EREGS(base, ctx, intr_num, reg, REG)
-#define RESTORE_GICD_EREGS(base, ctx, intr_num, reg, REG)
+#define RESTORE_GICD_EREGS(base, ctx, intr_num, reg, REG, w1s)
+#define SAVE_GICD_EREGS_64(base, ctx, intr_num, reg, REG)
+#define RESTORE_GICD_EREGS_64(base, ctx, intr_num, reg, REG)
 #endif /* GIC_EXT_INTID */
 
+/*
+ * The time spent in each phase of the GIC save and restore sequences is
+ * reported in verbose builds.
+ */
+static inline uint64_t gicv3_pm_timestamp(void)
+{
+	return (LOG_LEVEL >= LOG_LEVEL_VERBOSE) ? read_cntpct_el0() : 0U;
+}
+
+static inline unsigned long long gicv3_pm_elapsed_us(uint64_t start)
+{
+	uint64_t ticks = gicv3_pm_timestamp() - start;
+
+	return (unsigned long long)((ticks * 1000000U) / read_cntfrq_el0());
+}
+
+/*******************************************************************************
+ * This function returns a bitmap of the blocks of 32 interrupts, starting at
+ * INTID 'blk_base', that lie entirely within one of the platform's unused
+ * (E)SPI ranges. Bit n stands for INTIDs 'blk_base' + 32n to 'blk_base' + 32n
+ * + 31.
+ ******************************************************************************/
+static uint32_t __init gicv3_unused_blocks(const gicv3_driver_data_t *drv_data,
+					   unsigned int blk_base,
+					   unsigned int num_ints)
+{
+	const gicv3_intr_range_t *range;
+	unsigned int i, blk, first_blk, last_blk;
+	uint32_t bitmap = 0U;
+
+	for (i = 0U; i < drv_data->unused_spi_ranges_num; i++) {
+		range = &drv_data->unused_spi_ranges[i];
+		assert(range->first <= range->last);
+
+		if ((range->last < blk_base) ||
+		    (range->first >= (blk_base + num_ints))) {
+			continue;
+		}
+
+		/* Only count the blocks that are wholly inside the range */
+		first_blk = (range->first < blk_base) ? 0U :
+			((range->first - blk_base) + 31U) >> 5;
+		last_blk = (range->last >= (blk_base + num_ints - 1U)) ?
+			((num_ints + 31U) >> 5) :
+			((range->last - blk_base + 1U) >> 5);
+
+		for (blk = first_blk; blk < last_blk; blk++) {
+			bitmap |= U(1) << blk;
+		}
+	}
+
+	return bitmap;
+}
+
 /*******************************************************************************
  * This function initialises the ARM GICv3 driver in EL3 with provided platform
  * inputs.
@@ -162,6 +280,17 @@ void __init gicv3_driver_init(const gicv3_driver_data_t *plat_driver_data)
 	}
 	gicv3_driver_data = plat_driver_data;
 
+	assert((plat_driver_data->unused_spi_ranges_num != 0U) ?
+	       (plat_driver_data->unused_spi_ranges != NULL) : 1);
+
+	/* SGIs and PPIs are never skipped */
+	gicv3_unused_spis = gicv3_unused_blocks(plat_driver_data, 0U,
+						MAX_SPI_ID + 1U) & ~U(1);
+#if GIC_EXT_INTID
+	gicv3_unused_espis = gicv3_unused_blocks(plat_driver_data, MIN_ESPI_ID,
+						 MAX_ESPI_ID - MIN_ESPI_ID + 1U);
+#endif
+
 	/*
 	 * The GIC driver data is initialized by the primary CPU with caches
 	 * enabled. When the secondary CPU boots up, it initializes the
@@ -174,6 +303,12 @@ void __init gicv3_driver_init(const gicv3_driver_data_t *plat_driver_data)
 		sizeof(gicv3_driver_data));
 	flush_dcache_range((uintptr_t)gicv3_driver_data,
 		sizeof(*gicv3_driver_data));
+	flush_dcache_range((uintptr_t)&gicv3_unused_spis,
+		sizeof(gicv3_unused_spis));
+#if GIC_EXT_INTID
+	flush_dcache_range((uintptr_t)&gicv3_unused_espis,
+		sizeof(gicv3_unused_espis));
+#endif
 #endif
 	INFO("GICv%u with%s legacy support detected.\n", gic_version,
 				(gicv2_compat == 0U) ? "" : "out");
@@ -544,6 +679,7 @@ void gicv3_rdistif_save(unsigned int proc_num,
 {
 	uintptr_t gicr_base;
 	unsigned int i, ppi_regs_num, regs_num;
+	uint64_t start = gicv3_pm_timestamp();
 
 	assert(gicv3_driver_data != NULL);
 	assert(proc_num < gicv3_driver_data->rdistif_num);
@@ -605,6 +741,9 @@ void gicv3_rdistif_save(unsigned int proc_num,
 	 * the Redistributor registers, we pass it proc_num.
 	 */
 	gicv3_distif_pre_save(proc_num);
+
+	VERBOSE("GICv3: redistributor %u saved in %llu us\n", proc_num,
+		gicv3_pm_elapsed_us(start));
 }
 
 /*****************************************************************************
@@ -619,6 +758,7 @@ void gicv3_rdistif_init_restore(unsigned int proc_num,
 {
 	uintptr_t gicr_base;
 	unsigned int i, ppi_regs_num, regs_num;
+	uint64_t start = gicv3_pm_timestamp();
 
 	assert(gicv3_driver_data != NULL);
 	assert(proc_num < gicv3_driver_data->rdistif_num);
@@ -697,8 +837,8 @@ void gicv3_rdistif_init_restore(unsigned int proc_num,
 	 * 32 interrupt IDs per register
 	 */
 	for (i = 0U; i < ppi_regs_num; ++i) {
-		RESTORE_GICR_REG(gicr_base, rdist_ctx, ispendr, i);
-		RESTORE_GICR_REG(gicr_base, rdist_ctx, isactiver, i);
+		RESTORE_GICR_W1S_REG(gicr_base, rdist_ctx, ispendr, i);
+		RESTORE_GICR_W1S_REG(gicr_base, rdist_ctx, isactiver, i);
 	}
 
 	/*
@@ -709,7 +849,7 @@ void gicv3_rdistif_init_restore(unsigned int proc_num,
 
 	/* 32 interrupt IDs per GICR_ISENABLER register */
 	for (i = 0U; i < ppi_regs_num; ++i) {
-		RESTORE_GICR_REG(gicr_base, rdist_ctx, isenabler, i);
+		RESTORE_GICR_W1S_REG(gicr_base, rdist_ctx, isenabler, i);
 	}
 
 	/*
@@ -720,6 +860,9 @@ void gicv3_rdistif_init_restore(unsigned int proc_num,
 	 */
 	gicr_write_ctlr(gicr_base, rdist_ctx->gicr_ctlr);
 	gicr_wait_for_pending_write(gicr_base);
+
+	VERBOSE("GICv3: redistributor %u restored in %llu us\n", proc_num,
+		gicv3_pm_elapsed_us(start));
 }
 
 /*****************************************************************************
@@ -732,6 +875,7 @@ void gicv3_distif_save(gicv3_dist_ctx_t * const dist_ctx)
 #if GIC_EXT_INTID
 	unsigned int num_eints;
 #endif
+	uint64_t start = gicv3_pm_timestamp();
 
 	assert(gicv3_driver_data != NULL);
 	assert(gicv3_driver_data->gicd_base != 0U);
@@ -817,16 +961,19 @@ void gicv3_distif_save(gicv3_dist_ctx_t * const dist_ctx)
 	SAVE_GICD_EREGS(gicd_base, dist_ctx, num_eints, nsacr, NSAC);
 
 	/* Save GICD_IROUTER for INTIDs 32 - 1019 */
-	SAVE_GICD_REGS(gicd_base, dist_ctx, num_ints, irouter, IROUTE);
+	SAVE_GICD_REGS_64(gicd_base, dist_ctx, num_ints, irouter, IROUTE);
 
 	/* Save GICD_IROUTERE for INTIDs 4096 - 5119 */
-	SAVE_GICD_EREGS(gicd_base, dist_ctx, num_eints, irouter, IROUTE);
+	SAVE_GICD_EREGS_64(gicd_base, dist_ctx, num_eints, irouter, IROUTE);
 
 	/*
 	 * GICD_ITARGETSR<n> and GICD_SPENDSGIR<n> are RAZ/WI when
 	 * GICD_CTLR.ARE_(S|NS) bits are set which is the case for our GICv3
 	 * driver.
 	 */
+
+	VERBOSE("GICv3: distributor saved in %llu us\n",
+		gicv3_pm_elapsed_us(start));
 }
 
 /*****************************************************************************
@@ -842,6 +989,7 @@ void gicv3_distif_init_restore(const gicv3_dist_ctx_t * const dist_ctx)
 #if GIC_EXT_INTID
 	unsigned int num_eints;
 #endif
+	uint64_t start = gicv3_pm_timestamp();
 
 	assert(gicv3_driver_data != NULL);
 	assert(gicv3_driver_data->gicd_base != 0U);
@@ -887,40 +1035,54 @@ void gicv3_distif_init_restore(const gicv3_dist_ctx_t * const dist_ctx)
 	}
 #endif
 	/* Restore GICD_IGROUPR for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, igroupr, IGROUP);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, igroupr, IGROUP,
+			false);
 
 	/* Restore GICD_IGROUPRE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, igroupr, IGROUP);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, igroupr, IGROUP,
+			false);
 
 	/* Restore GICD_IPRIORITYR for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, ipriorityr, IPRIORITY);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, ipriorityr, IPRIORITY,
+			false);
 
 	/* Restore GICD_IPRIORITYRE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, ipriorityr, IPRIORITY);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, ipriorityr, IPRIORITY,
+			false);
 
 	/* Restore GICD_ICFGR for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, icfgr, ICFG);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, icfgr, ICFG,
+			false);
 
 	/* Restore GICD_ICFGRE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, icfgr, ICFG);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, icfgr, ICFG,
+			false);
 
 	/* Restore GICD_IGRPMODR for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, igrpmodr, IGRPMOD);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, igrpmodr, IGRPMOD,
+			false);
 
 	/* Restore GICD_IGRPMODRE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, igrpmodr, IGRPMOD);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, igrpmodr, IGRPMOD,
+			false);
 
 	/* Restore GICD_NSACR for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, nsacr, NSAC);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, nsacr, NSAC,
+			false);
 
 	/* Restore GICD_NSACRE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, nsacr, NSAC);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, nsacr, NSAC,
+			false);
 
 	/* Restore GICD_IROUTER for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, irouter, IROUTE);
+	RESTORE_GICD_REGS_64(gicd_base, dist_ctx, num_ints, irouter, IROUTE);
 
 	/* Restore GICD_IROUTERE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, irouter, IROUTE);
+	RESTORE_GICD_EREGS_64(gicd_base, dist_ctx, num_eints, irouter, IROUTE);
+
+	VERBOSE("GICv3: distributor configuration restored in %llu us\n",
+		gicv3_pm_elapsed_us(start));
+	start = gicv3_pm_timestamp();
 
 	/*
 	 * Restore ISENABLER(E), ISPENDR(E) and ISACTIVER(E) after
@@ -928,26 +1090,35 @@ void gicv3_distif_init_restore(const gicv3_dist_ctx_t * const dist_ctx)
 	 */
 
 	/* Restore GICD_ISENABLER for INT_IDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, isenabler, ISENABLE);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, isenabler, ISENABLE,
+			true);
 
 	/* Restore GICD_ISENABLERE for INT_IDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, isenabler, ISENABLE);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, isenabler, ISENABLE,
+			true);
 
 	/* Restore GICD_ISPENDR for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, ispendr, ISPEND);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, ispendr, ISPEND,
+			true);
 
 	/* Restore GICD_ISPENDRE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, ispendr, ISPEND);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, ispendr, ISPEND,
+			true);
 
 	/* Restore GICD_ISACTIVER for INTIDs 32 - 1019 */
-	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, isactiver, ISACTIVE);
+	RESTORE_GICD_REGS(gicd_base, dist_ctx, num_ints, isactiver, ISACTIVE,
+			true);
 
 	/* Restore GICD_ISACTIVERE for INTIDs 4096 - 5119 */
-	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, isactiver, ISACTIVE);
+	RESTORE_GICD_EREGS(gicd_base, dist_ctx, num_eints, isactiver, ISACTIVE,
+			true);
 
 	/* Restore the GICD_CTLR */
 	gicd_write_ctlr(gicd_base, dist_ctx->gicd_ctlr);
 	gicd_wait_for_pending_write(gicd_base);
+
+	VERBOSE("GICv3: distributor state restored in %llu us\n",
+		gicv3_pm_elapsed_us(start));
 }
 
 /*******************************************************************************
@@ -1291,6 +1462,49 @@ unsigned int gicv3_set_pmr(unsigned int mask)
 	return old_mask;
 }
 
+/*******************************************************************************
+ * This function walks the Redistributor frames starting at 'gicr_frame' once
+ * and saves the base address of the frame of every CPU found there, so that
+ * gicv3_rdistif_probe() does not need to walk them again when each CPU is
+ * first powered on. It is called by the primary CPU at cold boot, once for
+ * each set of contiguous frames, with the data cache enabled.
+ *
+ * The platform must provide a hash function: GICR_TYPER.Processor_Number is
+ * only unique within one GIC, so the frames of several chips would otherwise
+ * collide in rdistif_base_addrs[]. Without one, every CPU is left to find its
+ * own frame.
+ ******************************************************************************/
+void __init gicv3_rdistif_probe_all(const uintptr_t gicr_frame)
+{
+	assert(gicv3_driver_data != NULL);
+	assert(gicv3_driver_data->gicr_base == 0U);
+	assert(gicv3_driver_data->mpidr_to_core_pos != NULL);
+
+	if (gicv3_driver_data->mpidr_to_core_pos == NULL) {
+		return;
+	}
+
+	/* Ensure this function is called with Data Cache enabled */
+#ifndef __aarch64__
+	assert((read_sctlr() & SCTLR_C_BIT) != 0U);
+#else
+	assert((read_sctlr_el3() & SCTLR_C_BIT) != 0U);
+#endif /* !__aarch64__ */
+
+	gicv3_rdistif_base_addrs_probe(gicv3_driver_data->rdistif_base_addrs,
+				       gicv3_driver_data->rdistif_num,
+				       gicr_frame,
+				       gicv3_driver_data->mpidr_to_core_pos);
+#if !HW_ASSISTED_COHERENCY
+	/*
+	 * Flush the rdistif_base_addrs[] contents linked to the GICv3 driver.
+	 */
+	flush_dcache_range((uintptr_t)(gicv3_driver_data->rdistif_base_addrs),
+		gicv3_driver_data->rdistif_num *
+		sizeof(*(gicv3_driver_data->rdistif_base_addrs)));
+#endif
+}
+
 /*******************************************************************************
  * This function delegates the responsibility of discovering the corresponding
  * Redistributor frames to each CPU itself. It is a modified version of
@@ -1317,6 +1531,20 @@ int gicv3_rdistif_probe(const uintptr_t gicr_frame)
 #endif /* !__aarch64__ */
 
 	mpidr_self = read_mpidr_el1() & MPIDR_AFFINITY_MASK;
+
+	/*
+	 * The frame of this CPU is already known if it was found by an earlier
+	 * probe or by gicv3_rdistif_probe_all(). It can only be looked up
+	 * without walking the frames if the platform provides a hash function.
+	 */
+	if (gicv3_driver_data->mpidr_to_core_pos != NULL) {
+		proc_num = gicv3_driver_data->mpidr_to_core_pos(mpidr_self);
+		if ((proc_num < gicv3_driver_data->rdistif_num) &&
+		    (gicv3_driver_data->rdistif_base_addrs[proc_num] != 0U)) {
+			return 0;
+		}
+	}
+
 	rdistif_base = gicr_frame;
 	do {
 		typer_val = gicr_read_typer(rdistif_base);
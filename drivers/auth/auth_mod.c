@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -31,6 +32,136 @@
 
 #pragma weak plat_set_nv_ctr2
 
+/*
+ * Authentication cache. The parameters extracted from an authenticated image
+ * (hashes, public keys) are copied into buffers shared by several images of
+ * the CoT, so a sibling certificate may overwrite them. To be able to skip
+ * the verification of an already authenticated parent safely, a copy of its
+ * parameters is kept here and restored before a child uses them.
+ */
+#ifndef PLAT_AUTH_CACHE_ENTRIES
+# if IMAGE_BL1
+#  define PLAT_AUTH_CACHE_ENTRIES	U(4)
+# else
+#  define PLAT_AUTH_CACHE_ENTRIES	U(16)
+# endif
+#endif
+
+#ifndef PLAT_AUTH_CACHE_SIZE
+# if IMAGE_BL1
+#  define PLAT_AUTH_CACHE_SIZE		U(512)
+# else
+#  define PLAT_AUTH_CACHE_SIZE		U(4096)
+# endif
+#endif
+
+typedef struct auth_cache_entry_s {
+	unsigned int img_id;
+	unsigned int offset;
+	unsigned int len;
+} auth_cache_entry_t;
+
+static auth_cache_entry_t auth_cache[PLAT_AUTH_CACHE_ENTRIES];
+static unsigned int auth_cache_count;
+static unsigned char auth_cache_data[PLAT_AUTH_CACHE_SIZE];
+static unsigned int auth_cache_used;
+
+/* Number of parent verifications skipped thanks to the cache */
+static unsigned int auth_cache_hits;
+
+#if STREAM_HASH_AUTH
+/*
+ * Image whose hash is being computed while it is loaded. 'len' counts the
+ * number of bytes handed to the crypto module so far.
+ */
+static struct {
+	bool active;
+	unsigned int img_id;
+	unsigned int len;
+} stream_hash;
+#endif /* STREAM_HASH_AUTH */
+
+#if MEASURED_BOOT
+/*
+ * Digest cache. The hash of an image authenticated by hash is the one found
+ * in its parent, so it is kept here for measured boot to record the image
+ * without hashing it again. An entry is only valid for the image ID, address
+ * and size it was authenticated with, and is consumed by
+ * auth_mod_get_img_digest().
+ */
+#ifndef PLAT_AUTH_DIGEST_ENTRIES
+#define PLAT_AUTH_DIGEST_ENTRIES	U(4)
+#endif
+
+/* Size of a SHA-512 hash, the largest supported */
+#define AUTH_DIGEST_MAX_SIZE		U(64)
+
+typedef struct auth_digest_entry_s {
+	bool valid;
+	unsigned int img_id;
+	uintptr_t base;
+	unsigned int len;
+	unsigned int alg;
+	unsigned int digest_len;
+	unsigned char digest[AUTH_DIGEST_MAX_SIZE];
+} auth_digest_entry_t;
+
+static auth_digest_entry_t auth_digest[PLAT_AUTH_DIGEST_ENTRIES];
+static unsigned int auth_digest_next;
+
+static void auth_digest_invalidate(unsigned int img_id)
+{
+	unsigned int i;
+
+	for (i = 0U; i < PLAT_AUTH_DIGEST_ENTRIES; i++) {
+		if (auth_digest[i].img_id == img_id) {
+			auth_digest[i].valid = false;
+		}
+	}
+}
+
+/*
+ * Remember the hash that the image at 'img' of 'img_len' bytes has just been
+ * matched against. A failure is not an error: the image is then hashed again
+ * when it is measured.
+ */
+static void auth_digest_store(unsigned int img_id, void *img,
+			      unsigned int img_len, void *hash_der_ptr,
+			      unsigned int hash_der_len)
+{
+	auth_digest_entry_t *entry = NULL;
+	void *digest_ptr;
+	unsigned int alg, digest_len, i;
+
+	if ((crypto_mod_get_digest(hash_der_ptr, hash_der_len, &alg,
+				   &digest_ptr, &digest_len) != 0) ||
+	    (digest_len > AUTH_DIGEST_MAX_SIZE)) {
+		return;
+	}
+
+	/* Prefer a free entry, then replace the oldest one */
+	for (i = 0U; i < PLAT_AUTH_DIGEST_ENTRIES; i++) {
+		if (!auth_digest[i].valid) {
+			entry = &auth_digest[i];
+			break;
+		}
+	}
+
+	if (entry == NULL) {
+		entry = &auth_digest[auth_digest_next];
+		auth_digest_next = (auth_digest_next + 1U) %
+				   PLAT_AUTH_DIGEST_ENTRIES;
+	}
+
+	entry->img_id = img_id;
+	entry->base = (uintptr_t)img;
+	entry->len = img_len;
+	entry->alg = alg;
+	entry->digest_len = digest_len;
+	(void)memcpy(entry->digest, digest_ptr, digest_len);
+	entry->valid = true;
+}
+#endif /* MEASURED_BOOT */
 
 static int cmp_auth_param_type_desc(const auth_param_type_desc_t *a,
 		const auth_param_type_desc_t *b)
@@ -97,6 +228,7 @@ static int auth_hash(const auth_method_param_hash_t *param,
 {
 	void *data_ptr, *hash_der_ptr;
 	unsigned int data_len, hash_der_len;
+	bool hashed = false;
 	int rc = 0;
 
 	/* Get the hash from the parent image. This hash will be DER encoded
@@ -110,9 +242,31 @@ static int auth_hash(const auth_method_param_hash_t *param,
 			img, img_len, &data_ptr, &data_len);
 	return_if_error(rc);
 
-	/* Ask the crypto module to verify this hash */
-	rc = crypto_mod_verify_hash(data_ptr, data_len,
-				    hash_der_ptr, hash_der_len);
+#if STREAM_HASH_AUTH
+	/*
+	 * If the image was hashed while being loaded, only the final
+	 * comparison is left, provided the whole data was streamed.
+	 */
+	if (stream_hash.active && (stream_hash.img_id == img_desc->img_id)) {
+		stream_hash.active = false;
+		rc = crypto_mod_verify_hash_final();
+		hashed = (data_ptr == img) && (data_len == stream_hash.len);
+	}
+#endif /* STREAM_HASH_AUTH */
+
+	if (!hashed) {
+		/* Ask the crypto module to verify this hash */
+		rc = crypto_mod_verify_hash(data_ptr, data_len,
+					    hash_der_ptr, hash_der_len);
+	}
+
+#if MEASURED_BOOT
+	/* The whole image matches the hash, which can be measured as is */
+	if ((rc == 0) && (data_ptr == img) && (data_len == img_len)) {
+		auth_digest_store(img_desc->img_id, img, img_len,
+				  hash_der_ptr, hash_der_len);
+	}
+#endif
 
 	return rc;
 }
@@ -290,6 +444,116 @@ static int auth_nvctr(const auth_method_param_nv_ctr_t *param,
 	return 0;
 }
 
+/* Size of all the parameters an image passes on to its children */
+static unsigned int auth_cache_param_size(const auth_img_desc_t *img_desc)
+{
+	unsigned int len = 0U;
+	int i;
+
+	for (i = 0 ; i < COT_MAX_VERIFIED_PARAMS ; i++) {
+		if (img_desc->authenticated_data[i].type_desc != NULL) {
+			len += img_desc->authenticated_data[i].data.len;
+		}
+	}
+
+	return len;
+}
+
+static auth_cache_entry_t *auth_cache_find(unsigned int img_id)
+{
+	unsigned int i;
+
+	for (i = 0U; i < auth_cache_count; i++) {
+		if (auth_cache[i].img_id == img_id) {
+			return &auth_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Record the parameters extracted from a freshly authenticated image. If the
+ * cache is full the image is simply not cached, and it will be verified again
+ * if another child needs it.
+ */
+static void auth_cache_store(const auth_img_desc_t *img_desc)
+{
+	auth_cache_entry_t *entry;
+	unsigned int len, offset;
+	int i;
+
+	if (img_desc->authenticated_data == NULL) {
+		return;
+	}
+
+	len = auth_cache_param_size(img_desc);
+
+	entry = auth_cache_find(img_desc->img_id);
+	if (entry == NULL) {
+		if ((auth_cache_count == PLAT_AUTH_CACHE_ENTRIES) ||
+		    (len > (PLAT_AUTH_CACHE_SIZE - auth_cache_used))) {
+			return;
+		}
+
+		entry = &auth_cache[auth_cache_count];
+		entry->img_id = img_desc->img_id;
+		entry->offset = auth_cache_used;
+		entry->len = len;
+		auth_cache_count++;
+		auth_cache_used += len;
+	}
+
+	assert(entry->len == len);
+
+	offset = entry->offset;
+	for (i = 0 ; i < COT_MAX_VERIFIED_PARAMS ; i++) {
+		if (img_desc->authenticated_data[i].type_desc == NULL) {
+			continue;
+		}
+
+		memcpy(&auth_cache_data[offset],
+		       img_desc->authenticated_data[i].data.ptr,
+		       img_desc->authenticated_data[i].data.len);
+		offset += img_desc->authenticated_data[i].data.len;
+	}
+}
+
+/*
+ * Put the cached parameters of an authenticated image back in place.
+ *
+ * Return: 0 = restored, 1 = the image is not in the cache
+ */
+static int auth_cache_restore(const auth_img_desc_t *img_desc)
+{
+	const auth_cache_entry_t *entry;
+	unsigned int offset;
+	int i;
+
+	if (img_desc->authenticated_data == NULL) {
+		return 0;
+	}
+
+	entry = auth_cache_find(img_desc->img_id);
+	if (entry == NULL) {
+		return 1;
+	}
+
+	offset = entry->offset;
+	for (i = 0 ; i < COT_MAX_VERIFIED_PARAMS ; i++) {
+		if (img_desc->authenticated_data[i].type_desc == NULL) {
+			continue;
+		}
+
+		memcpy(img_desc->authenticated_data[i].data.ptr,
+		       &auth_cache_data[offset],
+		       img_desc->authenticated_data[i].data.len);
+		offset += img_desc->authenticated_data[i].data.len;
+	}
+
+	return 0;
+}
+
 int plat_set_nv_ctr2(void *cookie, const auth_img_desc_t *img_desc __unused,
 		unsigned int nv_ctr)
 {
@@ -316,16 +580,151 @@ int auth_mod_get_parent_id(unsigned int img_id, unsigned int *parent_id)
 		return 1;
 	}
 
-	/* Check if the parent has already been authenticated */
+	/*
+	 * Check if the parent has already been authenticated. Its verification
+	 * can only be skipped if the parameters it passes on to its children
+	 * can be restored from the cache, as they may have been overwritten
+	 * by another image since.
+	 */
 	if (auth_img_flags[img_desc->parent->img_id] & IMG_FLAG_AUTHENTICATED) {
-		*parent_id = 0;
-		return 1;
+		if (auth_cache_restore(img_desc->parent) == 0) {
+			auth_cache_hits++;
+			VERBOSE("Image id=%u already authenticated\n",
+				img_desc->parent->img_id);
+			*parent_id = 0;
+			return 1;
+		}
+
+		auth_img_flags[img_desc->parent->img_id] &=
+						~IMG_FLAG_AUTHENTICATED;
 	}
 
 	*parent_id = img_desc->parent->img_id;
 	return 0;
 }
 
+#if STREAM_HASH_AUTH
+/*
+ * Prepare to hash an image while it is being loaded
+ *
+ * This is only possible for raw images authenticated by hash, whose parent
+ * has already been authenticated. The data handed to
+ * auth_mod_stream_hash_update() must then be the image, in order, from its
+ * first byte.
+ *
+ * Return: 0 = streaming started, Otherwise = the image is hashed by
+ * auth_mod_verify_img() as usual
+ */
+int auth_mod_stream_hash_begin(unsigned int img_id)
+{
+	const auth_img_desc_t *img_desc = NULL;
+	const auth_method_param_hash_t *param = NULL;
+	void *hash_der_ptr;
+	unsigned int hash_der_len;
+	int rc, i;
+
+	stream_hash.active = false;
+
+	img_desc = FCONF_GET_PROPERTY(tbbr, cot, img_id);
+
+	if ((img_desc->img_type != IMG_RAW) ||
+	    (img_desc->img_auth_methods == NULL) ||
+	    (img_desc->parent == NULL)) {
+		return 1;
+	}
+
+	for (i = 0 ; i < AUTH_METHOD_NUM ; i++) {
+		if (img_desc->img_auth_methods[i].type == AUTH_METHOD_HASH) {
+			param = &img_desc->img_auth_methods[i].param.hash;
+			break;
+		}
+	}
+
+	if (param == NULL) {
+		return 1;
+	}
+
+	/* The hash to match comes from the already authenticated parent */
+	if ((auth_img_flags[img_desc->parent->img_id] &
+	     IMG_FLAG_AUTHENTICATED) == 0U) {
+		return 1;
+	}
+
+	rc = auth_get_param(param->hash, img_desc->parent,
+			&hash_der_ptr, &hash_der_len);
+	return_if_error(rc);
+
+	rc = crypto_mod_verify_hash_init(hash_der_ptr, hash_der_len);
+	return_if_error(rc);
+
+	stream_hash.img_id = img_id;
+	stream_hash.len = 0U;
+	stream_hash.active = true;
+
+	return 0;
+}
+
+/*
+ * Hand the next chunk of the image being loaded to the hash started by
+ * auth_mod_stream_hash_begin(). This is a no-op if no stream is active.
+ */
+void auth_mod_stream_hash_update(const void *data_ptr, unsigned int data_len)
+{
+	if (!stream_hash.active || (data_len == 0U)) {
+		return;
+	}
+
+	if (crypto_mod_verify_hash_update(data_ptr, data_len) != 0) {
+		/* Fall back to hashing the image once it is loaded */
+		stream_hash.active = false;
+		return;
+	}
+
+	stream_hash.len += data_len;
+}
+#endif /* STREAM_HASH_AUTH */
+
+/*
+ * Return the number of parent image verifications that were skipped because
+ * the parent had already been authenticated by this boot stage
+ */
+unsigned int auth_mod_get_cache_hits(void)
+{
+	return auth_cache_hits;
+}
+
+#if MEASURED_BOOT
+/*
+ * Copy to 'digest' the hash that the image 'img_id' loaded at 'base' with
+ * 'size' bytes was authenticated against, if it was computed with algorithm
+ * 'alg' and is 'digest_len' bytes long. The digest can only be retrieved
+ * once. Returns 0 on success and 1 if no such digest is known, in which case
+ * the caller has to hash the image itself.
+ */
+int auth_mod_get_img_digest(unsigned int img_id, uintptr_t base, size_t size,
+			    unsigned int alg, unsigned char *digest,
+			    unsigned int digest_len)
+{
+	auth_digest_entry_t *entry;
+	unsigned int i;
+
+	assert(digest != NULL);
+
+	for (i = 0U; i < PLAT_AUTH_DIGEST_ENTRIES; i++) {
+		entry = &auth_digest[i];
+		if (entry->valid && (entry->img_id == img_id) &&
+		    (entry->base == base) && (entry->len == size) &&
+		    (entry->alg == alg) && (entry->digest_len == digest_len)) {
+			(void)memcpy(digest, entry->digest, digest_len);
+			entry->valid = false;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+#endif /* MEASURED_BOOT */
+
 /*
  * Initialize the different modules in the authentication framework
  */
@@ -363,6 +762,11 @@ int auth_mod_verify_img(unsigned int img_id,
 	/* Get the image descriptor from the chain of trust */
 	img_desc = FCONF_GET_PROPERTY(tbbr, cot, img_id);
 
+#if MEASURED_BOOT
+	/* Any digest kept for this image ID belongs to a previous load */
+	auth_digest_invalidate(img_id);
+#endif
+
 	/* Ask the parser to check the image integrity */
 	rc = img_parser_check_integrity(img_desc->img_type, img_ptr, img_len);
 	return_if_error(rc);
@@ -435,8 +839,9 @@ int auth_mod_verify_img(unsigned int img_id,
 		}
 	}
 
-	/* Mark image as authenticated */
+	/* Mark image as authenticated and remember what it passes on */
 	auth_img_flags[img_desc->img_id] |= IMG_FLAG_AUTHENTICATED;
+	auth_cache_store(img_desc);
 
 	return 0;
 }
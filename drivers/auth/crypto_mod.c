@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -104,6 +104,59 @@ int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 					   digest_info_ptr, digest_info_len);
 }
 
+#if STREAM_HASH_AUTH
+/*
+ * Start verifying a hash incrementally
+ *
+ * Parameters:
+ *
+ *   digest_info_ptr, digest_info_len: hash to be compared once all the data
+ *                                     has been fed to the stream
+ *
+ * Returns CRYPTO_ERR_INIT if the library cannot hash incrementally.
+ */
+int crypto_mod_verify_hash_init(void *digest_info_ptr,
+				unsigned int digest_info_len)
+{
+	if (crypto_lib_hash_stream_desc.verify_hash_init == NULL) {
+		return CRYPTO_ERR_INIT;
+	}
+
+	assert(digest_info_ptr != NULL);
+	assert(digest_info_len != 0);
+
+	return crypto_lib_hash_stream_desc.verify_hash_init(digest_info_ptr,
+							    digest_info_len);
+}
+
+/*
+ * Feed data to the hash started by crypto_mod_verify_hash_init()
+ *
+ * Parameters:
+ *
+ *   data_ptr, data_len: data to be hashed
+ */
+int crypto_mod_verify_hash_update(const void *data_ptr, unsigned int data_len)
+{
+	assert(crypto_lib_hash_stream_desc.verify_hash_update != NULL);
+	assert(data_ptr != NULL);
+
+	return crypto_lib_hash_stream_desc.verify_hash_update(data_ptr,
+							      data_len);
+}
+
+/*
+ * Finish the hash started by crypto_mod_verify_hash_init() and compare it
+ * with the expected one
+ */
+int crypto_mod_verify_hash_final(void)
+{
+	assert(crypto_lib_hash_stream_desc.verify_hash_final != NULL);
+
+	return crypto_lib_hash_stream_desc.verify_hash_final();
+}
+#endif /* STREAM_HASH_AUTH */
+
 #if MEASURED_BOOT
 /*
  * Calculate a hash
@@ -123,6 +176,30 @@ int crypto_mod_calc_hash(unsigned int alg, void *data_ptr,
 
 	return crypto_lib_desc.calc_hash(alg, data_ptr, data_len, output);
 }
+
+/*
+ * Extract the hash algorithm and value of a DigestInfo
+ *
+ * Parameters:
+ *
+ *   digest_info_ptr, digest_info_len: DigestInfo to be parsed
+ *   alg: hash algorithm, as passed to crypto_mod_calc_hash() (out param)
+ *   digest_ptr, digest_len: hash value, within the DigestInfo (out params)
+ */
+int crypto_mod_get_digest(void *digest_info_ptr, unsigned int digest_info_len,
+			  unsigned int *alg, void **digest_ptr,
+			  unsigned int *digest_len)
+{
+	assert(crypto_lib_desc.get_digest != NULL);
+	assert(digest_info_ptr != NULL);
+	assert(digest_info_len != 0U);
+	assert(alg != NULL);
+	assert(digest_ptr != NULL);
+	assert(digest_len != NULL);
+
+	return crypto_lib_desc.get_digest(digest_info_ptr, digest_info_len, alg,
+					  digest_ptr, digest_len);
+}
 #endif	/* MEASURED_BOOT */
 
 /*
@@ -156,3 +233,63 @@ int crypto_mod_auth_decrypt(enum crypto_dec_algo dec_algo, void *data_ptr,
 					    key_len, key_flags, iv, iv_len, tag,
 					    tag_len);
 }
+
+#if STREAM_DECRYPTION
+/*
+ * Start an authenticated decryption of data fed incrementally
+ *
+ * Parameters:
+ *
+ *   dec_algo: authenticated decryption algorithm
+ *   key, key_len, key_flags: symmetric decryption key
+ *   iv, iv_len: initialization vector
+ */
+int crypto_mod_auth_decrypt_init(enum crypto_dec_algo dec_algo,
+				 const void *key, unsigned int key_len,
+				 unsigned int key_flags, const void *iv,
+				 unsigned int iv_len)
+{
+	assert(crypto_lib_dec_stream_desc.auth_decrypt_init != NULL);
+	assert(key != NULL);
+	assert(key_len != 0U);
+	assert(iv != NULL);
+	assert((iv_len != 0U) && (iv_len <= CRYPTO_MAX_IV_SIZE));
+
+	return crypto_lib_dec_stream_desc.auth_decrypt_init(dec_algo, key,
+							    key_len, key_flags,
+							    iv, iv_len);
+}
+
+/*
+ * Decrypt data in place as part of the decryption started by
+ * crypto_mod_auth_decrypt_init()
+ *
+ * Parameters:
+ *
+ *   data_ptr, len: data to be decrypted (inout param)
+ */
+int crypto_mod_auth_decrypt_update(void *data_ptr, size_t len)
+{
+	assert(crypto_lib_dec_stream_desc.auth_decrypt_update != NULL);
+	assert(data_ptr != NULL);
+
+	return crypto_lib_dec_stream_desc.auth_decrypt_update(data_ptr, len);
+}
+
+/*
+ * Finish the decryption started by crypto_mod_auth_decrypt_init() and check
+ * the authentication tag
+ *
+ * Parameters:
+ *
+ *   tag, tag_len: authentication tag
+ */
+int crypto_mod_auth_decrypt_final(const void *tag, unsigned int tag_len)
+{
+	assert(crypto_lib_dec_stream_desc.auth_decrypt_final != NULL);
+	assert(tag != NULL);
+	assert((tag_len != 0U) && (tag_len <= CRYPTO_MAX_TAG_SIZE));
+
+	return crypto_lib_dec_stream_desc.auth_decrypt_final(tag, tag_len);
+}
+#endif /* STREAM_DECRYPTION */
@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -140,19 +141,18 @@ end2:
 }
 
 /*
- * Match a hash
- *
- * Digest info is passed in DER format following the ASN.1 structure detailed
+ * Extract the message digest algorithm and the hash from a DigestInfo
+ * structure, passed in DER format following the ASN.1 structure detailed
  * above.
  */
-static int verify_hash(void *data_ptr, unsigned int data_len,
-		       void *digest_info_ptr, unsigned int digest_info_len)
+static int get_digest_info(void *digest_info_ptr, unsigned int digest_info_len,
+			   const mbedtls_md_info_t **md_info_out,
+			   unsigned char **hash_out)
 {
 	mbedtls_asn1_buf hash_oid, params;
 	mbedtls_md_type_t md_alg;
 	const mbedtls_md_info_t *md_info;
-	unsigned char *p, *end, *hash;
-	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	unsigned char *p, *end;
 	size_t len;
 	int rc;
 
@@ -191,7 +191,31 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	if (len != mbedtls_md_get_size(md_info)) {
 		return CRYPTO_ERR_HASH;
 	}
-	hash = p;
+
+	*md_info_out = md_info;
+	*hash_out = p;
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Match a hash
+ *
+ * Digest info is passed in DER format following the ASN.1 structure detailed
+ * above.
+ */
+static int verify_hash(void *data_ptr, unsigned int data_len,
+		       void *digest_info_ptr, unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *p, *hash;
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	int rc;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info, &hash);
+	if (rc != 0) {
+		return rc;
+	}
 
 	/* Calculate the hash of the data */
 	p = (unsigned char *)data_ptr;
@@ -209,6 +233,99 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	return CRYPTO_SUCCESS;
 }
 
+#if STREAM_HASH_AUTH
+/*
+ * State of the hash being verified incrementally. The expected hash is
+ * copied out of the DigestInfo so the caller's buffer need not outlive
+ * verify_hash_init().
+ */
+static mbedtls_md_context_t stream_md_ctx;
+static unsigned char stream_expected_hash[MBEDTLS_MD_MAX_SIZE];
+static size_t stream_hash_len;
+static bool stream_active;
+
+static void stream_hash_reset(void)
+{
+	if (stream_active) {
+		mbedtls_md_free(&stream_md_ctx);
+		stream_active = false;
+	}
+}
+
+/*
+ * Start matching a hash incrementally
+ *
+ * Digest info is passed in DER format following the ASN.1 structure detailed
+ * above.
+ */
+static int verify_hash_init(void *digest_info_ptr,
+			    unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *hash;
+	int rc;
+
+	stream_hash_reset();
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info, &hash);
+	if (rc != 0) {
+		return rc;
+	}
+
+	stream_hash_len = mbedtls_md_get_size(md_info);
+	memcpy(stream_expected_hash, hash, stream_hash_len);
+
+	mbedtls_md_init(&stream_md_ctx);
+	stream_active = true;
+
+	rc = mbedtls_md_setup(&stream_md_ctx, md_info, 0);
+	if (rc == 0) {
+		rc = mbedtls_md_starts(&stream_md_ctx);
+	}
+
+	if (rc != 0) {
+		stream_hash_reset();
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+static int verify_hash_update(const void *data_ptr, unsigned int data_len)
+{
+	if (!stream_active) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	if (mbedtls_md_update(&stream_md_ctx, data_ptr, data_len) != 0) {
+		stream_hash_reset();
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+static int verify_hash_final(void)
+{
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	int rc;
+
+	if (!stream_active) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	rc = mbedtls_md_finish(&stream_md_ctx, data_hash);
+	if (rc == 0) {
+		/* Compare values */
+		rc = memcmp(data_hash, stream_expected_hash, stream_hash_len);
+	}
+
+	stream_hash_reset();
+
+	return (rc == 0) ? CRYPTO_SUCCESS : CRYPTO_ERR_HASH;
+}
+#endif /* STREAM_HASH_AUTH */
+
 #if MEASURED_BOOT
 /*
  * Calculate a hash
@@ -228,60 +345,73 @@ int calc_hash(unsigned int alg, void *data_ptr,
 	/* Calculate the hash of the data */
 	return mbedtls_md(md_info, data_ptr, data_len, output);
 }
+
+/*
+ * Extract the hash algorithm and value of a DigestInfo
+ *
+ * Digest info is passed in DER format following the ASN.1 structure detailed
+ * above.
+ */
+static int get_digest(void *digest_info_ptr, unsigned int digest_info_len,
+		      unsigned int *alg, void **digest_ptr,
+		      unsigned int *digest_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *hash;
+	int rc;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info, &hash);
+	if (rc != 0) {
+		return rc;
+	}
+
+	*alg = (unsigned int)mbedtls_md_get_type(md_info);
+	*digest_ptr = hash;
+	*digest_len = mbedtls_md_get_size(md_info);
+
+	return CRYPTO_SUCCESS;
+}
 #endif /* MEASURED_BOOT */
 
 #if TF_MBEDTLS_USE_AES_GCM
 /*
- * Stack based buffer allocation for decryption operation. It could
- * be configured to balance stack usage vs execution speed.
+ * Initialise 'ctx' and start an AES-GCM decryption in it. The context must be
+ * freed by the caller, even on failure.
  */
-#define DEC_OP_BUF_SIZE		128
-
-static int aes_gcm_decrypt(void *data_ptr, size_t len, const void *key,
-			   unsigned int key_len, const void *iv,
-			   unsigned int iv_len, const void *tag,
-			   unsigned int tag_len)
+static int aes_gcm_starts(mbedtls_gcm_context *ctx, const void *key,
+			  unsigned int key_len, const void *iv,
+			  unsigned int iv_len)
 {
-	mbedtls_gcm_context ctx;
 	mbedtls_cipher_id_t cipher = MBEDTLS_CIPHER_ID_AES;
-	unsigned char buf[DEC_OP_BUF_SIZE];
-	unsigned char tag_buf[CRYPTO_MAX_TAG_SIZE];
-	unsigned char *pt = data_ptr;
-	size_t dec_len;
-	int diff, i, rc;
+	int rc;
 
-	mbedtls_gcm_init(&ctx);
+	mbedtls_gcm_init(ctx);
 
-	rc = mbedtls_gcm_setkey(&ctx, cipher, key, key_len * 8);
+	rc = mbedtls_gcm_setkey(ctx, cipher, key, key_len * 8);
 	if (rc != 0) {
-		rc = CRYPTO_ERR_DECRYPTION;
-		goto exit_gcm;
+		return CRYPTO_ERR_DECRYPTION;
 	}
 
-	rc = mbedtls_gcm_starts(&ctx, MBEDTLS_GCM_DECRYPT, iv, iv_len, NULL, 0);
+	rc = mbedtls_gcm_starts(ctx, MBEDTLS_GCM_DECRYPT, iv, iv_len, NULL, 0);
 	if (rc != 0) {
-		rc = CRYPTO_ERR_DECRYPTION;
-		goto exit_gcm;
+		return CRYPTO_ERR_DECRYPTION;
 	}
 
-	while (len > 0) {
-		dec_len = MIN(sizeof(buf), len);
-
-		rc = mbedtls_gcm_update(&ctx, dec_len, pt, buf);
-		if (rc != 0) {
-			rc = CRYPTO_ERR_DECRYPTION;
-			goto exit_gcm;
-		}
+	return CRYPTO_SUCCESS;
+}
 
-		memcpy(pt, buf, dec_len);
-		pt += dec_len;
-		len -= dec_len;
-	}
+/*
+ * Finish the AES-GCM decryption in 'ctx' and check the authentication tag
+ */
+static int aes_gcm_finish(mbedtls_gcm_context *ctx, const void *tag,
+			  unsigned int tag_len)
+{
+	unsigned char tag_buf[CRYPTO_MAX_TAG_SIZE];
+	int diff, i, rc;
 
-	rc = mbedtls_gcm_finish(&ctx, tag_buf, sizeof(tag_buf));
+	rc = mbedtls_gcm_finish(ctx, tag_buf, sizeof(tag_buf));
 	if (rc != 0) {
-		rc = CRYPTO_ERR_DECRYPTION;
-		goto exit_gcm;
+		return CRYPTO_ERR_DECRYPTION;
 	}
 
 	/* Check tag in "constant-time" */
@@ -289,12 +419,34 @@ static int aes_gcm_decrypt(void *data_ptr, size_t len, const void *key,
 		diff |= ((const unsigned char *)tag)[i] ^ tag_buf[i];
 
 	if (diff != 0) {
+		return CRYPTO_ERR_DECRYPTION;
+	}
+
+	/* GCM decryption success */
+	return CRYPTO_SUCCESS;
+}
+
+static int aes_gcm_decrypt(void *data_ptr, size_t len, const void *key,
+			   unsigned int key_len, const void *iv,
+			   unsigned int iv_len, const void *tag,
+			   unsigned int tag_len)
+{
+	mbedtls_gcm_context ctx;
+	int rc;
+
+	rc = aes_gcm_starts(&ctx, key, key_len, iv, iv_len);
+	if (rc != CRYPTO_SUCCESS) {
+		goto exit_gcm;
+	}
+
+	/* mbed TLS decrypts in place, so no bounce buffer is needed */
+	rc = mbedtls_gcm_update(&ctx, len, data_ptr, data_ptr);
+	if (rc != 0) {
 		rc = CRYPTO_ERR_DECRYPTION;
 		goto exit_gcm;
 	}
 
-	/* GCM decryption success */
-	rc = CRYPTO_SUCCESS;
+	rc = aes_gcm_finish(&ctx, tag, tag_len);
 
 exit_gcm:
 	mbedtls_gcm_free(&ctx);
@@ -327,6 +479,76 @@ static int auth_decrypt(enum crypto_dec_algo dec_algo, void *data_ptr,
 
 	return CRYPTO_SUCCESS;
 }
+
+#if STREAM_DECRYPTION
+/* State of the image being decrypted incrementally */
+static mbedtls_gcm_context stream_gcm_ctx;
+static bool stream_dec_active;
+
+static void stream_dec_reset(void)
+{
+	if (stream_dec_active) {
+		mbedtls_gcm_free(&stream_gcm_ctx);
+		stream_dec_active = false;
+	}
+}
+
+/*
+ * Start an authenticated decryption of an image fed incrementally
+ */
+static int auth_decrypt_init(enum crypto_dec_algo dec_algo, const void *key,
+			     unsigned int key_len, unsigned int key_flags,
+			     const void *iv, unsigned int iv_len)
+{
+	int rc;
+
+	assert((key_flags & ENC_KEY_IS_IDENTIFIER) == 0);
+
+	stream_dec_reset();
+
+	if (dec_algo != CRYPTO_GCM_DECRYPT) {
+		return CRYPTO_ERR_DECRYPTION;
+	}
+
+	stream_dec_active = true;
+
+	rc = aes_gcm_starts(&stream_gcm_ctx, key, key_len, iv, iv_len);
+	if (rc != CRYPTO_SUCCESS) {
+		stream_dec_reset();
+	}
+
+	return rc;
+}
+
+static int auth_decrypt_update(void *data_ptr, size_t len)
+{
+	if (!stream_dec_active) {
+		return CRYPTO_ERR_DECRYPTION;
+	}
+
+	if (mbedtls_gcm_update(&stream_gcm_ctx, len, data_ptr, data_ptr) != 0) {
+		stream_dec_reset();
+		return CRYPTO_ERR_DECRYPTION;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+static int auth_decrypt_final(const void *tag, unsigned int tag_len)
+{
+	int rc;
+
+	if (!stream_dec_active) {
+		return CRYPTO_ERR_DECRYPTION;
+	}
+
+	rc = aes_gcm_finish(&stream_gcm_ctx, tag, tag_len);
+
+	stream_dec_reset();
+
+	return rc;
+}
+#endif /* STREAM_DECRYPTION */
 #endif /* TF_MBEDTLS_USE_AES_GCM */
 
 /*
@@ -335,10 +557,10 @@ static int auth_decrypt(enum crypto_dec_algo dec_algo, void *data_ptr,
 #if MEASURED_BOOT
 #if TF_MBEDTLS_USE_AES_GCM
 REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash, calc_hash,
-		    auth_decrypt);
+		    get_digest, auth_decrypt);
 #else
 REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash, calc_hash,
-		    NULL);
+		    get_digest, NULL);
 #endif
 #else /* MEASURED_BOOT */
 #if TF_MBEDTLS_USE_AES_GCM
@@ -348,3 +570,13 @@ REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash,
 REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash, NULL);
 #endif
 #endif /* MEASURED_BOOT */
+
+#if STREAM_HASH_AUTH
+REGISTER_CRYPTO_LIB_HASH_STREAM(verify_hash_init, verify_hash_update,
+				verify_hash_final);
+#endif
+
+#if STREAM_DECRYPTION && TF_MBEDTLS_USE_AES_GCM
+REGISTER_CRYPTO_LIB_DEC_STREAM(auth_decrypt_init, auth_decrypt_update,
+			       auth_decrypt_final);
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -15,12 +15,32 @@
 #include <drivers/io/io_driver.h>
 #include <drivers/io/io_storage.h>
 #include <lib/utils.h>
+#include <lib/utils_def.h>
+
+#ifndef IO_BLOCK_CACHE_MAX_LINES
+#define IO_BLOCK_CACHE_MAX_LINES	0
+#endif
+
+#if IO_BLOCK_CACHE_MAX_LINES
+typedef struct {
+	unsigned long long	offset;	/* Device offset of the line data */
+	size_t			valid;	/* Number of valid bytes, 0 if free */
+	unsigned int		age;	/* Time of last use, for LRU */
+} block_cache_line_t;
+#endif
 
 typedef struct {
 	io_block_dev_spec_t	*dev_spec;
 	uintptr_t		base;
 	unsigned long long	file_pos;
 	unsigned long long	size;
+#if IO_BLOCK_CACHE_MAX_LINES
+	block_cache_line_t	lines[IO_BLOCK_CACHE_MAX_LINES];
+	unsigned int		line_count;
+	unsigned int		clock;
+	unsigned int		hits;
+	unsigned int		misses;
+#endif
 } block_dev_state_t;
 
 #define is_power_of_2(x)	(((x) != 0U) && (((x) & ((x) - 1U)) == 0U))
@@ -171,6 +191,116 @@ static int block_seek(io_entity_t *entity, int mode, signed long long offset)
 	return 0;
 }
 
+#if IO_BLOCK_CACHE_MAX_LINES
+/*
+ * Return the cache line holding the data at device offset 'offset', which is
+ * aligned to the line size. On a miss, the least recently used line is
+ * refilled with a single read of a whole line, which also reads ahead the
+ * blocks following the requested one. Returns NULL if nothing could be read.
+ */
+static block_cache_line_t *block_cache_get_line(block_dev_state_t *cur,
+						unsigned long long offset,
+						uintptr_t *data)
+{
+	io_block_dev_spec_t *dev_spec = cur->dev_spec;
+	size_t line_size = dev_spec->cache_line_size;
+	block_cache_line_t *line, *victim = &cur->lines[0];
+	unsigned int i;
+
+	for (i = 0U; i < cur->line_count; i++) {
+		line = &cur->lines[i];
+		if ((line->valid != 0U) && (line->offset == offset)) {
+			cur->hits++;
+			line->age = ++cur->clock;
+			*data = dev_spec->cache.offset + (i * line_size);
+			return line;
+		}
+		/* Free lines have an age of 0 and are picked first */
+		if (line->age < victim->age) {
+			victim = line;
+		}
+	}
+
+	cur->misses++;
+	i = (unsigned int)(victim - cur->lines);
+	*data = dev_spec->cache.offset + (i * line_size);
+	victim->offset = offset;
+	victim->valid = dev_spec->ops.read((int)(offset / dev_spec->block_size),
+					   *data, line_size);
+	/* The read may return less than requested, keep whole blocks only */
+	victim->valid &= ~(dev_spec->block_size - 1U);
+	if (victim->valid == 0U) {
+		victim->age = 0U;
+		return NULL;
+	}
+	victim->age = ++cur->clock;
+
+	return victim;
+}
+
+/*
+ * Serve a read from the cache. Returns the number of bytes copied to
+ * 'buffer', which is less than 'length' if a line could not be filled. The
+ * caller then reads the remaining data without the cache.
+ */
+static size_t block_cache_read(block_dev_state_t *cur, uintptr_t buffer,
+			       size_t length)
+{
+	unsigned long long line_mask = cur->dev_spec->cache_line_size - 1U;
+	unsigned long long pos;
+	block_cache_line_t *line;
+	size_t count = 0U, skip, nbytes;
+	uintptr_t data;
+
+	while (count < length) {
+		pos = cur->base + cur->file_pos;
+		skip = (size_t)(pos & line_mask);
+		line = block_cache_get_line(cur, pos - skip, &data);
+		if ((line == NULL) || (line->valid <= skip)) {
+			break;
+		}
+
+		nbytes = MIN(line->valid - skip, length - count);
+		memcpy((void *)(buffer + count), (void *)(data + skip), nbytes);
+		cur->file_pos += nbytes;
+		count += nbytes;
+	}
+
+	return count;
+}
+
+/* Drop the cache lines overlapping [offset, offset + length) */
+static void block_cache_invalidate_range(block_dev_state_t *cur,
+					 unsigned long long offset,
+					 size_t length)
+{
+	size_t line_size = cur->dev_spec->cache_line_size;
+	block_cache_line_t *line;
+	unsigned int i;
+
+	for (i = 0U; i < cur->line_count; i++) {
+		line = &cur->lines[i];
+		if ((line->valid != 0U) &&
+		    (line->offset < (offset + length)) &&
+		    (offset < (line->offset + line_size))) {
+			line->valid = 0U;
+			line->age = 0U;
+		}
+	}
+}
+
+/* Invalidate every line, whatever the device offset it caches */
+static void block_cache_invalidate_all(block_dev_state_t *cur)
+{
+	unsigned int i;
+
+	for (i = 0U; i < cur->line_count; i++) {
+		cur->lines[i].valid = 0U;
+		cur->lines[i].age = 0U;
+	}
+}
+#endif /* IO_BLOCK_CACHE_MAX_LINES */
+
 /*
  * This function allows the caller to read any number of bytes
  * from any position. It hides from the caller that the low level
@@ -240,6 +370,14 @@ static int block_seek(io_entity_t *entity, int mode, signed long long offset)
  *
  * Additionally, the IO driver has an underlying buffer that is at least
  * one block-size and may be big enough to allow.
+ *
+ * When the device has a read cache, reads smaller than a cache line are
+ * served from the cache instead, so that small sequential reads do not each
+ * cost a device transaction.
+ *
+ * When the device allows direct reads, whole blocks that are to be copied to
+ * a block-aligned address of the caller's buffer are read there directly,
+ * with no bounce through the underlying buffer.
  */
 static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		      size_t *length_read)
@@ -279,7 +417,13 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	 * on the low level driver.
 	 */
 	count = 0;
-	for (left = length; left > 0U; left -= nbytes) {
+#if IO_BLOCK_CACHE_MAX_LINES
+	if ((cur->line_count != 0U) &&
+	    (length < cur->dev_spec->cache_line_size)) {
+		count = block_cache_read(cur, buffer, length);
+	}
+#endif
+	for (left = length - count; left > 0U; left -= nbytes) {
 		/*
 		 * We must only request operations aligned to the block
 		 * size. Therefore if file_pos is not block-aligned,
@@ -296,6 +440,22 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		 */
 		lba = (cur->file_pos + cur->base) / block_size;
 
+		if ((cur->dev_spec->max_direct_read != 0U) && (skip == 0U) &&
+		    (left >= block_size) &&
+		    (((buffer + count) & (block_size - 1U)) == 0U)) {
+			/* Read whole blocks straight to the caller's buffer */
+			request = MIN(left & ~(block_size - 1U),
+				      cur->dev_spec->max_direct_read);
+			nbytes = ops->read(lba, buffer + count, request) &
+				 ~(block_size - 1U);
+			if (nbytes == 0U) {
+				return -EIO;
+			}
+			cur->file_pos += nbytes;
+			count += nbytes;
+			continue;
+		}
+
 		if ((skip + left) > buf->length) {
 			/*
 			 * The underlying read buffer is too small to
@@ -386,6 +546,10 @@ static int block_write(io_entity_t *entity, const uintptr_t buffer,
 	       (ops->read != 0) &&
 	       (ops->write != 0));
 
+#if IO_BLOCK_CACHE_MAX_LINES
+	block_cache_invalidate_range(cur, cur->base + cur->file_pos, length);
+#endif
+
 	/*
 	 * We don't know the number of bytes that we are going
 	 * to write in every iteration, because it will depend
@@ -518,7 +682,22 @@ static int block_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info)
 	assert((block_size > 0U) &&
 	       (is_power_of_2(block_size) != 0U) &&
 	       ((buffer->offset % block_size) == 0U) &&
-	       ((buffer->length % block_size) == 0U));
+	       ((buffer->length % block_size) == 0U) &&
+	       ((cur->dev_spec->max_direct_read % block_size) == 0U));
+
+#if IO_BLOCK_CACHE_MAX_LINES
+	if (cur->dev_spec->cache.length != 0U) {
+		size_t line_size = cur->dev_spec->cache_line_size;
+
+		assert((line_size >= block_size) &&
+		       (is_power_of_2(line_size) != 0U) &&
+		       ((cur->dev_spec->cache.offset % block_size) == 0U));
+		cur->line_count = MIN(cur->dev_spec->cache.length / line_size,
+				      (size_t)IO_BLOCK_CACHE_MAX_LINES);
+	}
+#else
+	assert(cur->dev_spec->cache.length == 0U);
+#endif
 
 	*dev_info = info;	/* cast away const */
 	(void)block_size;
@@ -528,6 +707,14 @@ static int block_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info)
 
 static int block_dev_close(io_dev_info_t *dev_info)
 {
+#if IO_BLOCK_CACHE_MAX_LINES
+	block_dev_state_t *cur = (block_dev_state_t *)dev_info->info;
+
+	if (cur->line_count != 0U) {
+		INFO("io_block: %u cache hits, %u misses\n", cur->hits,
+		     cur->misses);
+	}
+#endif
 	return free_dev_info(dev_info);
 }
 
@@ -549,3 +736,20 @@ int register_io_dev_block(const io_dev_connector_t **dev_con)
 		*dev_con = &block_dev_connector;
 	return result;
 }
+
+/*
+ * Invalidate the read cache of all the open block devices. This must be
+ * called if a block device is written to without going through this driver.
+ */
+void io_block_cache_invalidate(void)
+{
+#if IO_BLOCK_CACHE_MAX_LINES
+	unsigned int i;
+
+	for (i = 0U; i < MAX_IO_BLOCK_DEVICES; i++) {
+		if (state_pool[i].dev_spec != NULL) {
+			block_cache_invalidate_all(&state_pool[i]);
+		}
+	}
+#endif
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020, Linaro Limited. All rights reserved.
+ * Copyright (c) 2020-2021, Linaro Limited. All rights reserved.
  * Author: Sumit Garg <sumit.garg@linaro.org>
  *
  * SPDX-License-Identifier: BSD-3-Clause
@@ -7,17 +7,20 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
 #include <platform_def.h>
 
+#include <arch_helpers.h>
 #include <common/bl_common.h>
 #include <common/debug.h>
 #include <drivers/auth/crypto_mod.h>
 #include <drivers/io/io_driver.h>
 #include <drivers/io/io_encrypted.h>
 #include <drivers/io/io_storage.h>
+#include <lib/cassert.h>
 #include <lib/utils.h>
 #include <plat/common/platform.h>
 #include <tools_share/firmware_encrypted.h>
@@ -30,6 +33,37 @@ static uintptr_t backend_image_spec;
 
 static io_dev_info_t enc_dev_info;
 
+#if STREAM_DECRYPTION
+/*
+ * Size of the chunks in which the encrypted payload is read. Each chunk is
+ * decrypted in place right after it lands, while it is still hot in the data
+ * cache.
+ */
+#ifndef ENC_STREAM_CHUNK_SIZE
+#define ENC_STREAM_CHUNK_SIZE	U(0x8000)
+#endif
+
+CASSERT((ENC_STREAM_CHUNK_SIZE % CRYPTO_DEC_BLOCK_SIZE) == 0U,
+	assert_enc_stream_chunk_size_not_block_aligned);
+
+/*
+ * State of the payload being decrypted. The payload may be read through
+ * successive calls to enc_file_read(), as long as they fill a contiguous
+ * buffer from 'base', so that the whole payload can be wiped if it turns out
+ * not to be authentic.
+ */
+static struct {
+	struct fw_enc_hdr header;
+	uintptr_t base;
+	size_t size;
+	size_t done;
+	uint64_t ticks;
+	bool started;
+	bool finished;
+	bool failed;
+} enc_stream;
+#endif /* STREAM_DECRYPTION */
+
 /* Encrypted firmware driver functions */
 static int enc_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info);
 static int enc_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
@@ -115,6 +149,10 @@ static int enc_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 
 	backend_image_spec = spec;
 
+#if STREAM_DECRYPTION
+	(void)memset(&enc_stream, 0, sizeof(enc_stream));
+#endif
+
 	result = io_open(backend_dev_handle, backend_image_spec,
 			 &backend_handle);
 	if (result != 0) {
@@ -150,42 +188,216 @@ static int enc_file_len(io_entity_t *entity, size_t *length)
 	return result;
 }
 
-static int enc_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
-			 size_t *length_read)
+static unsigned long long enc_ticks_to_us(uint64_t ticks)
+{
+	return (unsigned long long)((ticks * 1000000U) / read_cntfrq_el0());
+}
+
+static int enc_read_header(struct fw_enc_hdr *header)
 {
 	int result;
-	struct fw_enc_hdr header;
-	enum fw_enc_status_t fw_enc_status;
 	size_t bytes_read;
-	uint8_t key[ENC_MAX_KEY_SIZE];
-	size_t key_len = sizeof(key);
-	unsigned int key_flags = 0;
-	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)backend_image_spec;
 
-	assert(entity != NULL);
-	assert(length_read != NULL);
-
-	result = io_read(backend_handle, (uintptr_t)&header, sizeof(header),
+	result = io_read(backend_handle, (uintptr_t)header, sizeof(*header),
 			 &bytes_read);
 	if (result != 0) {
 		WARN("Failed to read encryption header (%i)\n", result);
 		return -ENOENT;
 	}
 
-	if (!is_valid_header(&header)) {
+	if (!is_valid_header(header)) {
 		WARN("Encryption header check failed.\n");
 		return -ENOENT;
 	}
 
 	VERBOSE("Encryption header looks OK.\n");
-	fw_enc_status = header.flags & FW_ENC_STATUS_FLAG_MASK;
 
-	if ((header.iv_len > ENC_MAX_IV_SIZE) ||
-	    (header.tag_len > ENC_MAX_TAG_SIZE)) {
+	if ((header->iv_len > ENC_MAX_IV_SIZE) ||
+	    (header->tag_len > ENC_MAX_TAG_SIZE)) {
 		WARN("Incorrect IV or tag length\n");
 		return -ENOENT;
 	}
 
+	return 0;
+}
+
+#if STREAM_DECRYPTION
+/* Wipe the part of the payload that has been decrypted but not authenticated */
+static void enc_stream_abort(size_t len)
+{
+	zeromem((void *)enc_stream.base, enc_stream.done + len);
+	enc_stream.failed = true;
+}
+
+static int enc_stream_start(uintptr_t buffer)
+{
+	int result;
+	enum fw_enc_status_t fw_enc_status;
+	uint8_t key[ENC_MAX_KEY_SIZE];
+	size_t key_len = sizeof(key);
+	unsigned int key_flags = 0;
+	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)backend_image_spec;
+
+	result = io_size(backend_handle, &enc_stream.size);
+	if ((result != 0) || (enc_stream.size < sizeof(struct fw_enc_hdr))) {
+		WARN("Failed to read blob length (%i)\n", result);
+		return -ENOENT;
+	}
+
+	/* The payload follows the encryption header */
+	enc_stream.size -= sizeof(struct fw_enc_hdr);
+
+	result = enc_read_header(&enc_stream.header);
+	if (result != 0) {
+		return result;
+	}
+
+	fw_enc_status = enc_stream.header.flags & FW_ENC_STATUS_FLAG_MASK;
+
+	result = plat_get_enc_key_info(fw_enc_status, key, &key_len, &key_flags,
+				       (uint8_t *)&uuid_spec->uuid,
+				       sizeof(uuid_t));
+	if (result != 0) {
+		WARN("Failed to obtain encryption key (%i)\n", result);
+		return -ENOENT;
+	}
+
+	result = crypto_mod_auth_decrypt_init(enc_stream.header.dec_algo, key,
+					      key_len, key_flags,
+					      enc_stream.header.iv,
+					      enc_stream.header.iv_len);
+	memset(key, 0, key_len);
+
+	if (result != 0) {
+		ERROR("File decryption failed (%i)\n", result);
+		return -ENOENT;
+	}
+
+	enc_stream.base = buffer;
+	enc_stream.started = true;
+
+	return 0;
+}
+
+/*
+ * Read and decrypt the next 'length' bytes of the payload into 'buffer', one
+ * chunk at a time. The authentication tag is checked when the last byte of
+ * the payload is read, before it is returned to the caller.
+ */
+static int enc_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
+			 size_t *length_read)
+{
+	int result;
+	size_t offset = 0U;
+	size_t chunk, bytes_read;
+	uint64_t start;
+
+	assert(entity != NULL);
+	assert(length_read != NULL);
+
+	if (enc_stream.failed) {
+		return -ENOENT;
+	}
+
+	if (enc_stream.finished) {
+		*length_read = 0U;
+		return 0;
+	}
+
+	if (!enc_stream.started) {
+		result = enc_stream_start(buffer);
+		if (result != 0) {
+			enc_stream.failed = true;
+			return result;
+		}
+	} else if (buffer != (enc_stream.base + enc_stream.done)) {
+		WARN("Encrypted payload must be read sequentially\n");
+		return -EINVAL;
+	}
+
+	length = MIN(length, enc_stream.size - enc_stream.done);
+
+	/* Only the end of the payload may be a partial block */
+	if (((enc_stream.done + length) < enc_stream.size) &&
+	    ((length % CRYPTO_DEC_BLOCK_SIZE) != 0U)) {
+		WARN("Encrypted payload read not aligned to %u bytes\n",
+		     CRYPTO_DEC_BLOCK_SIZE);
+		return -EINVAL;
+	}
+
+	start = read_cntpct_el0();
+
+	while (offset < length) {
+		chunk = MIN(length - offset, (size_t)ENC_STREAM_CHUNK_SIZE);
+
+		result = io_read(backend_handle, buffer + offset, chunk,
+				 &bytes_read);
+		if ((result != 0) || (bytes_read != chunk)) {
+			WARN("Failed to read encrypted payload (%i)\n", result);
+			enc_stream_abort(offset + chunk);
+			return -ENOENT;
+		}
+
+		result = crypto_mod_auth_decrypt_update((void *)(buffer + offset),
+							chunk);
+		if (result != 0) {
+			ERROR("File decryption failed (%i)\n", result);
+			enc_stream_abort(offset + chunk);
+			return -ENOENT;
+		}
+
+		offset += chunk;
+	}
+
+	if ((enc_stream.done + length) == enc_stream.size) {
+		result = crypto_mod_auth_decrypt_final(enc_stream.header.tag,
+						       enc_stream.header.tag_len);
+		if (result != 0) {
+			ERROR("File decryption failed (%i)\n", result);
+			enc_stream_abort(length);
+			return -ENOENT;
+		}
+
+		enc_stream.finished = true;
+	}
+
+	enc_stream.done += length;
+	enc_stream.ticks += read_cntpct_el0() - start;
+	*length_read = length;
+
+	if (enc_stream.finished) {
+		VERBOSE("Read and decrypted %zu bytes in %llu us\n",
+			enc_stream.size, enc_ticks_to_us(enc_stream.ticks));
+	}
+
+	return 0;
+}
+#else
+static int enc_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
+			 size_t *length_read)
+{
+	int result;
+	struct fw_enc_hdr header;
+	enum fw_enc_status_t fw_enc_status;
+	size_t bytes_read;
+	uint8_t key[ENC_MAX_KEY_SIZE];
+	size_t key_len = sizeof(key);
+	unsigned int key_flags = 0;
+	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)backend_image_spec;
+	uint64_t start;
+
+	assert(entity != NULL);
+	assert(length_read != NULL);
+
+	start = read_cntpct_el0();
+
+	result = enc_read_header(&header);
+	if (result != 0) {
+		return result;
+	}
+
+	fw_enc_status = header.flags & FW_ENC_STATUS_FLAG_MASK;
+
 	result = io_read(backend_handle, buffer, length, &bytes_read);
 	if (result != 0) {
 		WARN("Failed to read encrypted payload (%i)\n", result);
@@ -214,11 +426,22 @@ static int enc_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		return -ENOENT;
 	}
 
+	VERBOSE("Read and decrypted %zu bytes in %llu us\n", *length_read,
+		enc_ticks_to_us(read_cntpct_el0() - start));
+
 	return result;
 }
+#endif /* STREAM_DECRYPTION */
 
 static int enc_file_close(io_entity_t *entity)
 {
+#if STREAM_DECRYPTION
+	/* Do not leave a partially read payload that was not authenticated */
+	if (enc_stream.started && !enc_stream.finished && !enc_stream.failed) {
+		enc_stream_abort(0U);
+	}
+#endif
+
 	io_close(backend_handle);
 
 	backend_image_spec = (uintptr_t)NULL;
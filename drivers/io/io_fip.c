@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2014-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2014-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -33,32 +34,54 @@
 		x.node[0], x.node[1], x.node[2], x.node[3],			\
 		x.node[4], x.node[5]
 
+#ifndef MAX_FIP_TOC_ENTRIES
+#define MAX_FIP_TOC_ENTRIES	32
+#endif
+
+#ifndef MAX_FIP_FILES
+#define MAX_FIP_FILES		MAX_IO_HANDLES
+#endif
+
+/*
+ * Per open file state. The ToC entry is copied from the device, so it stays
+ * valid if the device re-reads its ToC. We know the header lives at offset
+ * zero, so the entry offset is never zero for an open file and a zero offset
+ * marks a free slot.
+ */
 typedef struct {
 	unsigned int file_pos;
 	fip_toc_entry_t entry;
 } fip_file_state_t;
 
 /*
- * Maintain dev_spec per FIP Device
- * TODO - Add backend handles and file state
- * per FIP device here once backends like io_memmap
- * can support multiple open files
+ * Maintain dev_spec, backend handles and a cached copy of the Table of
+ * Contents per FIP device. The ToC is read once by fip_dev_init() and kept
+ * sorted by UUID so that fip_file_open() can look entries up without any
+ * backend I/O. If the ToC has more than MAX_FIP_TOC_ENTRIES entries, only the
+ * first ones are cached and the others are looked up in the backend. The
+ * region of the backend the ToC was read from is kept along with the backend
+ * handles, as platforms may update the image spec in place.
  */
 typedef struct {
 	uintptr_t dev_spec;
 	uint16_t plat_toc_flag;
+	uintptr_t backend_dev_handle;
+	uintptr_t backend_image_spec;
+	io_block_spec_t backend_region;
+	unsigned int toc_count;
+	unsigned int toc_reads;
+	unsigned int reads_saved;
+	bool toc_valid;
+	bool toc_complete;
+	fip_toc_entry_t toc[MAX_FIP_TOC_ENTRIES];
 } fip_dev_state_t;
 
 /*
- * Only one file can be open across all FIP device
- * as backends like io_memmap don't support
- * multiple open files. The file state and
- * backend handle should be maintained per FIP device
- * if the same support is available in the backend
+ * Backends like io_memmap only support one open file at a time, so the
+ * backend is still opened for the duration of each read. Files in the
+ * package only carry a cursor and can therefore be opened concurrently.
  */
-static fip_file_state_t current_fip_file = {0};
-static uintptr_t backend_dev_handle;
-static uintptr_t backend_image_spec;
+static fip_file_state_t file_pool[MAX_FIP_FILES];
 
 static fip_dev_state_t state_pool[MAX_FIP_DEVICES];
 static io_dev_info_t dev_info_pool[MAX_FIP_DEVICES];
@@ -183,8 +206,8 @@ static int free_dev_info(io_dev_info_t *dev_info)
 
 /*
  * Multiple FIP devices can be opened depending on the value of
- * MAX_FIP_DEVICES. Given that there is only one backend, only a
- * single file can be open at a time by any FIP device.
+ * MAX_FIP_DEVICES. Up to MAX_FIP_FILES files can be open at a time
+ * across all FIP devices.
  */
 static int fip_dev_open(const uintptr_t dev_spec,
 			 io_dev_info_t **dev_info)
@@ -212,12 +235,223 @@ static int fip_dev_open(const uintptr_t dev_spec,
 }
 
 
-/* Do some basic package checks. */
+/*
+ * Read the Table of Contents that follows the FIP header into the device
+ * state. Entries are read in as few backend transactions as the size of the
+ * backend file allows, then sorted by UUID for lookup by fip_file_open().
+ * Up to MAX_FIP_TOC_ENTRIES entries are cached; a longer ToC leaves
+ * 'toc_complete' clear.
+ */
+static int fip_load_toc(fip_dev_state_t *state, uintptr_t backend_handle)
+{
+	static const uuid_t uuid_null = { {0} }; /* Double braces for clang */
+	fip_toc_entry_t *entry;
+	size_t backend_size;
+	size_t avail = MAX_FIP_TOC_ENTRIES;
+	size_t batch;
+	size_t bytes_read;
+	unsigned int count = 0U;
+	unsigned int i, j;
+	bool bounded = false;
+	int result;
+
+	/*
+	 * If the backend can report its size, bound the ToC reads by it so
+	 * that the whole table is fetched in one go. Otherwise fall back to
+	 * reading a single entry at a time.
+	 */
+	if ((io_size(backend_handle, &backend_size) == 0) &&
+	    (backend_size > sizeof(fip_toc_header_t))) {
+		backend_size -= sizeof(fip_toc_header_t);
+		if ((backend_size / sizeof(fip_toc_entry_t)) < avail) {
+			avail = backend_size / sizeof(fip_toc_entry_t);
+			bounded = true;
+		}
+		batch = avail;
+	} else {
+		batch = 1U;
+	}
+
+	for (;;) {
+		if (count == avail) {
+			if (bounded) {
+				WARN("FIP ToC not terminated within %u entries\n",
+				     (unsigned int)avail);
+				return -ENOENT;
+			}
+
+			/* The rest is looked up by fip_scan_toc() */
+			VERBOSE("FIP ToC has more than %u entries\n",
+				(unsigned int)avail);
+			goto toc_end;
+		}
+
+		if (batch > (avail - count)) {
+			batch = avail - count;
+		}
+
+		result = io_read(backend_handle, (uintptr_t)&state->toc[count],
+				 batch * sizeof(fip_toc_entry_t), &bytes_read);
+		state->toc_reads++;
+		if ((result != 0) ||
+		    (bytes_read != (batch * sizeof(fip_toc_entry_t)))) {
+			WARN("Failed to read FIP ToC (%i)\n", result);
+			return -ENOENT;
+		}
+
+		/* Stop at the ToC end marker, which has a null UUID */
+		for (i = 0U; i < batch; i++) {
+			if (compare_uuids(&state->toc[count].uuid,
+					  &uuid_null) == 0) {
+				state->toc_complete = true;
+				goto toc_end;
+			}
+			count++;
+		}
+	}
+
+toc_end:
+	/*
+	 * Insertion sort by UUID. It is stable, so if the package holds
+	 * duplicate UUIDs the one listed first in the ToC still wins.
+	 */
+	for (i = 1U; i < count; i++) {
+		fip_toc_entry_t tmp = state->toc[i];
+
+		for (j = i; j > 0U; j--) {
+			entry = &state->toc[j - 1U];
+			if (compare_uuids(&entry->uuid, &tmp.uuid) <= 0) {
+				break;
+			}
+			state->toc[j] = *entry;
+		}
+		state->toc[j] = tmp;
+	}
+
+	state->toc_count = count;
+
+	return 0;
+}
+
+/* Binary search for a UUID in the cached ToC of a FIP device */
+static const fip_toc_entry_t *fip_find_toc_entry(const fip_dev_state_t *state,
+						 const uuid_t *uuid)
+{
+	unsigned int lo = 0U;
+	unsigned int hi = state->toc_count;
+	unsigned int mid;
+	int cmp;
+
+	while (lo < hi) {
+		mid = lo + ((hi - lo) / 2U);
+		cmp = compare_uuids(&state->toc[mid].uuid, uuid);
+		if (cmp < 0) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if ((lo < state->toc_count) &&
+	    (compare_uuids(&state->toc[lo].uuid, uuid) == 0)) {
+		return &state->toc[lo];
+	}
+
+	return NULL;
+}
+
+/*
+ * Look a UUID up in the part of the ToC that did not fit in the cache, reading
+ * one entry at a time from the backend.
+ */
+static int fip_scan_toc(const fip_dev_state_t *state, const uuid_t *uuid,
+			fip_toc_entry_t *entry)
+{
+	static const uuid_t uuid_null = { {0} }; /* Double braces for clang */
+	uintptr_t backend_handle;
+	size_t bytes_read;
+	int result;
+
+	result = io_open(state->backend_dev_handle, state->backend_image_spec,
+			 &backend_handle);
+	if (result != 0) {
+		WARN("Failed to open Firmware Image Package (%i)\n", result);
+		return -ENOENT;
+	}
+
+	/* Seek past the FIP header and the cached entries */
+	result = io_seek(backend_handle, IO_SEEK_SET,
+			 (signed long long)(sizeof(fip_toc_header_t) +
+			 (state->toc_count * sizeof(fip_toc_entry_t))));
+	if (result != 0) {
+		WARN("fip_scan_toc: failed to seek\n");
+		result = -ENOENT;
+		goto fip_scan_toc_close;
+	}
+
+	do {
+		result = io_read(backend_handle, (uintptr_t)entry,
+				 sizeof(*entry), &bytes_read);
+		if ((result != 0) || (bytes_read != sizeof(*entry))) {
+			WARN("Failed to read FIP (%i)\n", result);
+			result = -ENOENT;
+			goto fip_scan_toc_close;
+		}
+		if (compare_uuids(&entry->uuid, &uuid_null) == 0) {
+			/* Did not find the file in the FIP. */
+			result = -ENOENT;
+			goto fip_scan_toc_close;
+		}
+	} while (compare_uuids(&entry->uuid, uuid) != 0);
+
+ fip_scan_toc_close:
+	io_close(backend_handle);
+
+	return result;
+}
+
+/*
+ * Return true if the cached ToC was read from the backend image that the
+ * platform now returns for the package. The specs of memmap and block devices
+ * are compared by contents, since the platform may have moved the package
+ * without changing the spec pointer, for instance to switch to a backup FIP.
+ * MTD devices ignore the spec. For other backends the meaning of the spec is
+ * unknown, so the ToC is always read again.
+ */
+static bool fip_toc_is_current(const fip_dev_state_t *state,
+			       uintptr_t backend_dev_handle,
+			       uintptr_t backend_image_spec)
+{
+	const io_dev_info_t *backend = (const io_dev_info_t *)backend_dev_handle;
+	const io_block_spec_t *region;
+
+	if (!state->toc_valid ||
+	    (state->backend_dev_handle != backend_dev_handle) ||
+	    (state->backend_image_spec != backend_image_spec)) {
+		return false;
+	}
+
+	switch (backend->funcs->type()) {
+	case IO_TYPE_MEMMAP:
+	case IO_TYPE_BLOCK:
+		region = (const io_block_spec_t *)backend_image_spec;
+		return (region->offset == state->backend_region.offset) &&
+		       (region->length == state->backend_region.length);
+	case IO_TYPE_MTD:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Do some basic package checks and cache the Table of Contents. */
 static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 {
 	int result;
 	unsigned int image_id = (unsigned int)init_params;
 	uintptr_t backend_handle;
+	uintptr_t backend_dev_handle;
+	uintptr_t backend_image_spec;
 	fip_toc_header_t header;
 	size_t bytes_read;
 	fip_dev_state_t *state;
@@ -236,6 +470,33 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 		goto fip_dev_init_exit;
 	}
 
+	/*
+	 * Platforms call io_dev_init() before every image load. If the
+	 * package has already been validated on the same backend region, the
+	 * cached ToC is still good and no backend access is needed.
+	 */
+	if (fip_toc_is_current(state, backend_dev_handle,
+			       backend_image_spec)) {
+		state->reads_saved += state->toc_reads;
+		return 0;
+	}
+
+	state->toc_valid = false;
+	state->toc_complete = false;
+	state->toc_count = 0U;
+	state->toc_reads = 0U;
+	state->backend_dev_handle = backend_dev_handle;
+	state->backend_image_spec = backend_image_spec;
+
+	switch (((io_dev_info_t *)backend_dev_handle)->funcs->type()) {
+	case IO_TYPE_MEMMAP:
+	case IO_TYPE_BLOCK:
+		state->backend_region = *(io_block_spec_t *)backend_image_spec;
+		break;
+	default:
+		break;
+	}
+
 	/* Attempt to access the FIP image */
 	result = io_open(backend_dev_handle, backend_image_spec,
 			 &backend_handle);
@@ -247,6 +508,7 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 
 	result = io_read(backend_handle, (uintptr_t)&header, sizeof(header),
 			&bytes_read);
+	state->toc_reads++;
 	if (result == 0) {
 		if (!is_valid_header(&header)) {
 			WARN("Firmware Image Package header check failed.\n");
@@ -258,6 +520,15 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 			 * bits [32-47] in fip header.
 			 */
 			state->plat_toc_flag = (header.flags >> 32) & 0xffff;
+
+			result = fip_load_toc(state, backend_handle);
+			if (result == 0) {
+				VERBOSE("FIP ToC cached, %u entries%s.\n",
+					state->toc_count,
+					state->toc_complete ? "" :
+					" (incomplete)");
+				state->toc_valid = true;
+			}
 		}
 	}
 
@@ -270,12 +541,19 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 /* Close a connection to the FIP device */
 static int fip_dev_close(io_dev_info_t *dev_info)
 {
+	fip_dev_state_t *state;
+
+	assert(dev_info != NULL);
+
 	/* TODO: Consider tracking open files and cleaning them up here */
 
-	/* Clear the backend. */
-	backend_dev_handle = (uintptr_t)NULL;
-	backend_image_spec = (uintptr_t)NULL;
+	state = (fip_dev_state_t *)dev_info->info;
+	if (state->reads_saved != 0U) {
+		INFO("FIP: %u backend reads saved by reusing the cached ToC\n",
+		     state->reads_saved);
+	}
 
+	/* Clearing the device state also drops the backend and cached ToC */
 	return free_dev_info(dev_info);
 }
 
@@ -284,82 +562,59 @@ static int fip_dev_close(io_dev_info_t *dev_info)
 static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 			 io_entity_t *entity)
 {
-	int result;
-	uintptr_t backend_handle;
 	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)spec;
-	static const uuid_t uuid_null = { {0} }; /* Double braces for clang */
-	size_t bytes_read;
-	int found_file = 0;
+	const fip_toc_entry_t *entry;
+	fip_dev_state_t *state;
+	fip_file_state_t *fp = NULL;
+	unsigned int index;
+	int result;
 
+	assert(dev_info != NULL);
 	assert(uuid_spec != NULL);
 	assert(entity != NULL);
 
-	/* Can only have one file open at a time for the moment. We need to
-	 * track state like file cursor position. We know the header lives at
-	 * offset zero, so this entry should never be zero for an active file.
-	 * When the system supports dynamic memory allocation we can allow more
-	 * than one open file at a time if needed.
-	 */
-	if (current_fip_file.entry.offset_address != 0U) {
-		WARN("fip_file_open : Only one open file at a time.\n");
-		return -ENFILE;
+	state = (fip_dev_state_t *)dev_info->info;
+
+	if (!state->toc_valid) {
+		WARN("fip_file_open: FIP device not initialised\n");
+		return -ENOENT;
 	}
 
-	/* Attempt to access the FIP image */
-	result = io_open(backend_dev_handle, backend_image_spec,
-			 &backend_handle);
-	if (result != 0) {
-		WARN("Failed to open Firmware Image Package (%i)\n", result);
-		result = -ENOENT;
-		goto fip_file_open_exit;
+	for (index = 0U; index < (unsigned int)MAX_FIP_FILES; index++) {
+		if (file_pool[index].entry.offset_address == 0U) {
+			fp = &file_pool[index];
+			break;
+		}
 	}
 
-	/* Seek past the FIP header into the Table of Contents */
-	result = io_seek(backend_handle, IO_SEEK_SET,
-			 (signed long long)sizeof(fip_toc_header_t));
-	if (result != 0) {
-		WARN("fip_file_open: failed to seek\n");
-		result = -ENOENT;
-		goto fip_file_open_close;
+	if (fp == NULL) {
+		WARN("fip_file_open: Too many open files.\n");
+		return -ENFILE;
 	}
 
-	found_file = 0;
-	do {
-		result = io_read(backend_handle,
-				 (uintptr_t)&current_fip_file.entry,
-				 sizeof(current_fip_file.entry),
-				 &bytes_read);
-		if (result == 0) {
-			if (compare_uuids(&current_fip_file.entry.uuid,
-					  &uuid_spec->uuid) == 0) {
-				found_file = 1;
-			}
-		} else {
-			WARN("Failed to read FIP (%i)\n", result);
-			goto fip_file_open_close;
+	entry = fip_find_toc_entry(state, &uuid_spec->uuid);
+	if (entry != NULL) {
+		fp->entry = *entry;
+	} else if (!state->toc_complete) {
+		result = fip_scan_toc(state, &uuid_spec->uuid, &fp->entry);
+		if (result != 0) {
+			zeromem(fp, sizeof(*fp));
+			return result;
 		}
-	} while ((found_file == 0) &&
-			(compare_uuids(&current_fip_file.entry.uuid,
-				&uuid_null) != 0));
-
-	if (found_file == 1) {
-		/* All fine. Update entity info with file state and return. Set
-		 * the file position to 0. The 'current_fip_file.entry' holds
-		 * the base and size of the file.
-		 */
-		current_fip_file.file_pos = 0;
-		entity->info = (uintptr_t)&current_fip_file;
 	} else {
 		/* Did not find the file in the FIP. */
-		current_fip_file.entry.offset_address = 0;
-		result = -ENOENT;
+		return -ENOENT;
 	}
 
- fip_file_open_close:
-	io_close(backend_handle);
+	/*
+	 * All fine. Update entity info with file state and return. Set the
+	 * file position to 0. The 'entry' holds the base and size of the
+	 * file.
+	 */
+	fp->file_pos = 0;
+	entity->info = (uintptr_t)fp;
 
- fip_file_open_exit:
-	return result;
+	return 0;
 }
 
 
@@ -381,6 +636,7 @@ static int fip_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 {
 	int result;
 	fip_file_state_t *fp;
+	fip_dev_state_t *state;
 	size_t file_offset;
 	size_t bytes_read;
 	uintptr_t backend_handle;
@@ -389,8 +645,10 @@ static int fip_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	assert(length_read != NULL);
 	assert(entity->info != (uintptr_t)NULL);
 
+	state = (fip_dev_state_t *)entity->dev_handle->info;
+
 	/* Open the backend, attempt to access the blob image */
-	result = io_open(backend_dev_handle, backend_image_spec,
+	result = io_open(state->backend_dev_handle, state->backend_image_spec,
 			 &backend_handle);
 	if (result != 0) {
 		WARN("Failed to open FIP (%i)\n", result);
@@ -434,11 +692,14 @@ static int fip_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 /* Close a file in package */
 static int fip_file_close(io_entity_t *entity)
 {
-	/* Clear our current file pointer.
-	 * If we had malloc() we would free() here.
-	 */
-	if (current_fip_file.entry.offset_address != 0U) {
-		zeromem(&current_fip_file, sizeof(current_fip_file));
+	fip_file_state_t *fp;
+
+	assert(entity != NULL);
+
+	/* Release the file state back to the pool */
+	fp = (fip_file_state_t *)entity->info;
+	if (fp != NULL) {
+		zeromem(fp, sizeof(*fp));
 	}
 
 	/* Clear the Entity info. */
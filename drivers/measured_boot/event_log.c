@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2021, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -11,6 +11,7 @@
 
 #include <common/bl_common.h>
 #include <common/debug.h>
+#include <drivers/auth/auth_mod.h>
 #include <drivers/auth/crypto_mod.h>
 #include <drivers/measured_boot/event_log.h>
 #include <mbedtls/md.h>
@@ -309,11 +310,23 @@ int tpm_record_measurement(uintptr_t data_base, uint32_t data_size,
 		/* No action */
 	}
 
-	/* Calculate hash */
-	rc = crypto_mod_calc_hash((unsigned int)MBEDTLS_MD_ID,
-				(void *)data_base, data_size, hash_data);
-	if (rc != 0) {
-		return rc;
+	/*
+	 * Reuse the hash the image has just been authenticated against, and
+	 * only calculate it if the image was not authenticated by hash or with
+	 * a different algorithm.
+	 */
+	if (auth_mod_get_img_digest(data_id, data_base, data_size,
+				    (unsigned int)MBEDTLS_MD_ID, hash_data,
+				    TCG_DIGEST_SIZE) == 0) {
+		VERBOSE("Measured image %u with its authenticated hash\n",
+			data_id);
+	} else {
+		rc = crypto_mod_calc_hash((unsigned int)MBEDTLS_MD_ID,
+					(void *)data_base, data_size,
+					hash_data);
+		if (rc != 0) {
+			return rc;
+		}
 	}
 
 	return add_event2(hash_data, data_ptr);
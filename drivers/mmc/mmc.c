@@ -22,6 +22,9 @@
 
 #define MULT_BY_512K_SHIFT		19
 
+/* The block count argument of CMD23 is 16-bit wide */
+#define CMD23_MAX_BLOCK_COUNT		U(0xFFFF)
+
 static const struct mmc_ops *ops;
 static unsigned int mmc_ocr_value;
 static struct mmc_csd_emmc mmc_csd;
@@ -30,6 +33,8 @@ static unsigned int mmc_flags;
 static struct mmc_device_info *mmc_dev_info;
 static unsigned int rca;
 static unsigned int scr[2]__aligned(16) = { 0 };
+/* Largest transfer supported by the host controller, 0 if unlimited */
+static size_t mmc_max_transfer_size;
 
 static const unsigned char tran_speed_base[16] = {
 	0, 10, 12, 13, 15, 20, 26, 30, 35, 40, 45, 52, 55, 60, 70, 80
@@ -497,16 +502,25 @@ static int mmc_enumerate(unsigned int clk, unsigned int bus_width)
 	return mmc_fill_device_info();
 }
 
-size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
+/* Return the largest number of bytes that one transfer can move. */
+static size_t mmc_transfer_size_limit(void)
+{
+	size_t limit = mmc_max_transfer_size;
+
+	if (is_cmd23_enabled() &&
+	    ((limit == 0U) ||
+	     (limit > (CMD23_MAX_BLOCK_COUNT * MMC_BLOCK_SIZE)))) {
+		limit = CMD23_MAX_BLOCK_COUNT * MMC_BLOCK_SIZE;
+	}
+
+	return limit;
+}
+
+static size_t mmc_read_transfer(int lba, uintptr_t buf, size_t size)
 {
 	int ret;
 	unsigned int cmd_idx, cmd_arg;
 
-	assert((ops != NULL) &&
-	       (ops->read != NULL) &&
-	       (size != 0U) &&
-	       ((size & MMC_BLOCK_MASK) == 0U));
-
 	ret = ops->prepare(lba, buf, size);
 	if (ret != 0) {
 		return 0;
@@ -564,6 +578,47 @@ size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
 	return size;
 }
 
+/*
+ * Read 'size' bytes starting at block 'lba'. The read is done in as few
+ * multi-block transfers as the host controller and CMD23 allow. Returns the
+ * number of bytes read, which is less than 'size' if a transfer failed.
+ */
+size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
+{
+	size_t limit, chunk, done = 0U;
+
+	assert((ops != NULL) &&
+	       (ops->read != NULL) &&
+	       (size != 0U) &&
+	       ((size & MMC_BLOCK_MASK) == 0U));
+
+	limit = mmc_transfer_size_limit();
+	while (done < size) {
+		chunk = size - done;
+		if ((limit != 0U) && (chunk > limit)) {
+			chunk = limit;
+		}
+		if (mmc_read_transfer(lba, buf + done, chunk) != chunk) {
+			break;
+		}
+		lba += (int)(chunk / MMC_BLOCK_SIZE);
+		done += chunk;
+	}
+
+	return done;
+}
+
+/*
+ * Set the largest number of bytes the host controller can move in a single
+ * transfer. It must be a multiple of the block size, 0 means no limit.
+ */
+void mmc_set_max_transfer_size(size_t size)
+{
+	assert((size & MMC_BLOCK_MASK) == 0U);
+
+	mmc_max_transfer_size = size;
+}
+
 size_t mmc_write_blocks(int lba, const uintptr_t buf, size_t size)
 {
 	int ret;
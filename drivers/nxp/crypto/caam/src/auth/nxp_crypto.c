@@ -121,3 +121,8 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
  * Register crypto library descriptor
  */
 REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash, NULL);
+
+#if STREAM_HASH_AUTH
+/* Images are hashed once loaded: incremental hashing is not supported */
+REGISTER_CRYPTO_LIB_HASH_STREAM(NULL, NULL, NULL);
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -12,6 +12,14 @@
 #include <drivers/partition/gpt.h>
 #include <lib/utils.h>
 
+/* CRC32 (IEEE 802.3) of each 4-bit value, for the reflected polynomial */
+static const uint32_t crc32_nibble_table[16] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+	0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+	0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
 static int unicode_to_ascii(unsigned short *str_in, unsigned char *str_out)
 {
 	uint8_t *name;
@@ -52,6 +60,7 @@ int parse_gpt_entry(gpt_entry_t *gpt_entry, partition_entry_t *entry)
 	if (result != 0) {
 		return result;
 	}
+	memcpy(&entry->part_guid, gpt_entry->unique_uuid, GUID_LEN);
 	entry->start = (uint64_t)gpt_entry->first_lba *
 		       PLAT_PARTITION_BLOCK_SIZE;
 	entry->length = (uint64_t)(gpt_entry->last_lba -
@@ -59,3 +68,23 @@ int parse_gpt_entry(gpt_entry_t *gpt_entry, partition_entry_t *entry)
 			PLAT_PARTITION_BLOCK_SIZE;
 	return 0;
 }
+
+/*
+ * Update the CRC32 used by GPT headers and partition entry arrays with the
+ * content of buf. The CRC of a buffer split in several parts can be computed
+ * by chaining the calls, starting with a crc of 0.
+ */
+uint32_t gpt_crc32(uint32_t crc, const uint8_t *buf, size_t size)
+{
+	size_t i;
+
+	assert((buf != NULL) || (size == 0U));
+
+	crc = ~crc;
+	for (i = 0U; i < size; i++) {
+		crc = crc32_nibble_table[(crc ^ buf[i]) & 0xfU] ^ (crc >> 4);
+		crc = crc32_nibble_table[(crc ^ ((uint32_t)buf[i] >> 4)) &
+					 0xfU] ^ (crc >> 4);
+	}
+	return ~crc;
+}
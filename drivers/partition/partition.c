@@ -1,10 +1,13 @@
 /*
- * Copyright (c) 2016-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -13,11 +16,20 @@
 #include <drivers/partition/partition.h>
 #include <drivers/partition/gpt.h>
 #include <drivers/partition/mbr.h>
+#include <lib/utils_def.h>
 #include <plat/common/platform.h>
 
+/*
+ * Block buffer used for the MBR sector. It is also used for the GPT header
+ * and for reading the GPT entry array one block at a time.
+ */
 static uint8_t mbr_sector[PLAT_PARTITION_BLOCK_SIZE];
 static partition_entry_list_t list;
 
+/* Indices of the GPT entries of list, sorted by partition GUID */
+static uint8_t guid_index[PLAT_PARTITION_MAX_ENTRIES];
+static int guid_index_count;
+
 #if LOG_LEVEL >= LOG_LEVEL_VERBOSE
 static void dump_entries(int num)
 {
@@ -74,31 +86,56 @@ static int load_mbr_header(uintptr_t image_handle, mbr_entry_t *mbr_entry)
 }
 
 /*
- * Load GPT header and check the GPT signature.
+ * Load GPT header, check the GPT signature and the CRC32 of the header.
  * If partition numbers could be found, check & update it.
  */
-static int load_gpt_header(uintptr_t image_handle)
+static int load_gpt_header(uintptr_t image_handle, gpt_header_t *header)
 {
-	gpt_header_t header;
 	size_t bytes_read;
+	uint32_t crc;
 	int result;
 
+	/* Read the whole block so that the block device needs no bounce. */
 	result = io_seek(image_handle, IO_SEEK_SET, GPT_HEADER_OFFSET);
 	if (result != 0) {
 		return result;
 	}
-	result = io_read(image_handle, (uintptr_t)&header,
-			 sizeof(gpt_header_t), &bytes_read);
-	if ((result != 0) || (sizeof(gpt_header_t) != bytes_read)) {
-		return result;
+	result = io_read(image_handle, (uintptr_t)&mbr_sector,
+			 PLAT_PARTITION_BLOCK_SIZE, &bytes_read);
+	if ((result != 0) || (bytes_read != PLAT_PARTITION_BLOCK_SIZE)) {
+		return (result != 0) ? result : -EIO;
+	}
+	memcpy(header, mbr_sector, sizeof(gpt_header_t));
+	if (memcmp(header->signature, GPT_SIGNATURE,
+		   sizeof(header->signature)) != 0) {
+		return -EINVAL;
+	}
+
+	if ((header->size < GPT_HEADER_SIZE) ||
+	    (header->size > PLAT_PARTITION_BLOCK_SIZE)) {
+		WARN("Invalid GPT header size (%u)\n", header->size);
+		return -EINVAL;
 	}
-	if (memcmp(header.signature, GPT_SIGNATURE,
-		   sizeof(header.signature)) != 0) {
+	/* The header CRC is computed with the CRC field itself zeroed. */
+	memset(&mbr_sector[offsetof(gpt_header_t, header_crc)], 0,
+	       sizeof(header->header_crc));
+	crc = gpt_crc32(0U, mbr_sector, header->size);
+	if (crc != header->header_crc) {
+		WARN("GPT header CRC mismatch (0x%x != 0x%x)\n", crc,
+		     header->header_crc);
+		return -EINVAL;
+	}
+	if (header->part_size != sizeof(gpt_entry_t)) {
+		WARN("Unsupported GPT entry size (%u)\n", header->part_size);
+		return -EINVAL;
+	}
+	if ((header->list_num == 0U) || (header->list_num > GPT_MAX_ENTRIES)) {
+		WARN("Invalid GPT entry count (%u)\n", header->list_num);
 		return -EINVAL;
 	}
 
 	/* partition numbers can't exceed PLAT_PARTITION_MAX_ENTRIES */
-	list.entry_count = header.list_num;
+	list.entry_count = header->list_num;
 	if (list.entry_count > PLAT_PARTITION_MAX_ENTRIES) {
 		list.entry_count = PLAT_PARTITION_MAX_ENTRIES;
 	}
@@ -156,31 +193,78 @@ static int load_mbr_entries(uintptr_t image_handle)
 	return 0;
 }
 
-static int load_gpt_entry(uintptr_t image_handle, gpt_entry_t *entry)
+static int compare_guid(const struct efi_guid *guid1,
+			const struct efi_guid *guid2)
 {
-	size_t bytes_read;
-	int result;
-
-	assert(entry != NULL);
-	result = io_read(image_handle, (uintptr_t)entry, sizeof(gpt_entry_t),
-			 &bytes_read);
-	if (sizeof(gpt_entry_t) != bytes_read)
-		return -EINVAL;
-	return result;
+	return memcmp(guid1, guid2, sizeof(struct efi_guid));
 }
 
-static int verify_partition_gpt(uintptr_t image_handle)
+/* Sort the valid GPT entries by partition GUID for lookups. */
+static void build_guid_index(void)
 {
-	gpt_entry_t entry;
-	int result, i;
+	const struct efi_guid *guid;
+	int i, j;
 
 	for (i = 0; i < list.entry_count; i++) {
-		result = load_gpt_entry(image_handle, &entry);
-		assert(result == 0);
-		result = parse_gpt_entry(&entry, &list.list[i]);
-		if (result != 0) {
-			break;
+		guid = &list.list[i].part_guid;
+		for (j = i; j > 0; j--) {
+			if (compare_guid(&list.list[guid_index[j - 1]].part_guid,
+					 guid) <= 0) {
+				break;
+			}
+			guid_index[j] = guid_index[j - 1];
 		}
+		guid_index[j] = (uint8_t)i;
+	}
+	guid_index_count = list.entry_count;
+}
+
+/*
+ * Read the GPT entry array one block at a time, check its CRC32 and parse the
+ * leading valid entries. The whole array is read, even beyond
+ * PLAT_PARTITION_MAX_ENTRIES, because the CRC32 covers all of it. Its size was
+ * bounded by GPT_MAX_ENTRIES in load_gpt_header().
+ */
+static int verify_partition_gpt(uintptr_t image_handle,
+				const gpt_header_t *header)
+{
+	size_t remaining = (size_t)header->list_num * sizeof(gpt_entry_t);
+	size_t bytes_read, batch, offset;
+	gpt_entry_t entry;
+	bool parsing = true;
+	uint32_t crc = 0U;
+	int result, i = 0;
+
+	while (remaining > 0U) {
+		batch = MIN(remaining, sizeof(mbr_sector));
+		result = io_read(image_handle, (uintptr_t)&mbr_sector, batch,
+				 &bytes_read);
+		if ((result != 0) || (bytes_read != batch)) {
+			WARN("Failed to read GPT entries (%i)\n", result);
+			return (result != 0) ? result : -EIO;
+		}
+		crc = gpt_crc32(crc, mbr_sector, batch);
+
+		for (offset = 0U; parsing && (offset < batch);
+		     offset += sizeof(gpt_entry_t)) {
+			if (i >= list.entry_count) {
+				parsing = false;
+				break;
+			}
+			memcpy(&entry, &mbr_sector[offset], sizeof(gpt_entry_t));
+			if (parse_gpt_entry(&entry, &list.list[i]) != 0) {
+				parsing = false;
+				break;
+			}
+			i++;
+		}
+		remaining -= batch;
+	}
+
+	if (crc != header->part_crc) {
+		WARN("GPT entries CRC mismatch (0x%x != 0x%x)\n", crc,
+		     header->part_crc);
+		return -EINVAL;
 	}
 	if (i == 0) {
 		return -EINVAL;
@@ -190,6 +274,7 @@ static int verify_partition_gpt(uintptr_t image_handle)
 	 * partition table.
 	 */
 	list.entry_count = i;
+	build_guid_index();
 	dump_entries(list.entry_count);
 
 	return 0;
@@ -199,6 +284,7 @@ int load_partition_table(unsigned int image_id)
 {
 	uintptr_t dev_handle, image_handle, image_spec = 0;
 	mbr_entry_t mbr_entry;
+	gpt_header_t header;
 	int result;
 
 	result = plat_get_image_source(image_id, &dev_handle, &image_spec);
@@ -219,12 +305,17 @@ int load_partition_table(unsigned int image_id)
 		WARN("Failed to access image id=%u (%i)\n", image_id, result);
 		return result;
 	}
+	guid_index_count = 0;
 	if (mbr_entry.type == PARTITION_TYPE_GPT) {
-		result = load_gpt_header(image_handle);
-		assert(result == 0);
+		result = load_gpt_header(image_handle, &header);
+		if (result != 0) {
+			WARN("Failed to load GPT header (%i)\n", result);
+			io_close(image_handle);
+			return result;
+		}
 		result = io_seek(image_handle, IO_SEEK_SET, GPT_ENTRY_OFFSET);
 		assert(result == 0);
-		result = verify_partition_gpt(image_handle);
+		result = verify_partition_gpt(image_handle, &header);
 	} else {
 		result = load_mbr_entries(image_handle);
 	}
@@ -245,6 +336,33 @@ const partition_entry_t *get_partition_entry(const char *name)
 	return NULL;
 }
 
+/*
+ * Look up a GPT partition by its unique partition GUID, using a binary search
+ * in the GUID index. Always returns NULL for MBR partition tables.
+ */
+const partition_entry_t *get_partition_entry_by_guid(
+					const struct efi_guid *part_guid)
+{
+	const partition_entry_t *entry;
+	int low = 0, high = guid_index_count - 1, mid, cmp;
+
+	assert(part_guid != NULL);
+
+	while (low <= high) {
+		mid = low + ((high - low) / 2);
+		entry = &list.list[guid_index[mid]];
+		cmp = compare_guid(&entry->part_guid, part_guid);
+		if (cmp == 0) {
+			return entry;
+		} else if (cmp < 0) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	return NULL;
+}
+
 const partition_entry_list_t *get_partition_entry_list(void)
 {
 	return &list;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -427,6 +427,10 @@ void dw_mmc_init(dw_mmc_params_t *params, struct mmc_device_info *info)
 
 	memcpy(&dw_params, params, sizeof(dw_mmc_params_t));
 	dw_params.mmc_dev_type = info->mmc_dev_type;
+	/* dw_prepare() needs one descriptor per DWMMC_DMA_MAX_BUFFER_SIZE */
+	mmc_set_max_transfer_size(((params->desc_size - 1U) /
+				   sizeof(struct dw_idmac_desc)) *
+				  DWMMC_DMA_MAX_BUFFER_SIZE);
 	mmc_init(&dw_mmc_ops, params->clk_rate, params->bus_width,
 		 params->flags, info);
 }
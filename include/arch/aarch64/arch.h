@@ -199,6 +199,8 @@
 /* ID_AA64ISAR0_EL1 definitions */
 #define ID_AA64ISAR0_RNDR_SHIFT U(60)
 #define ID_AA64ISAR0_RNDR_MASK  ULL(0xf)
+#define ID_AA64ISAR0_CRC32_SHIFT U(16)
+#define ID_AA64ISAR0_CRC32_MASK	ULL(0xf)
 
 /* ID_AA64ISAR1_EL1 definitions */
 #define ID_AA64ISAR1_EL1	S3_0_C0_C6_1
@@ -725,6 +727,13 @@
 
 #define MAX_CACHE_LINE_SIZE	U(0x800) /* 2KB */
 
+/*
+ * DCZID_EL0 definitions
+ */
+#define DCZID_BS_SHIFT		U(0)
+#define DCZID_BS_MASK		U(0xf)
+#define DCZID_DZP_BIT		(U(1) << 4)
+
 /* Physical timer control register bit fields shifts and masks */
 #define CNTP_CTL_ENABLE_SHIFT	U(0)
 #define CNTP_CTL_IMASK_SHIFT	U(1)
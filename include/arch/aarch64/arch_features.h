@@ -17,6 +17,13 @@ static inline bool is_armv7_gentimer_present(void)
 	return true;
 }
 
+static inline bool is_armv8_1_crc32_present(void)
+{
+	/* FEAT_CRC32 is mandatory from Armv8.1 and optional in Armv8.0 */
+	return ((read_id_aa64isar0_el1() >> ID_AA64ISAR0_CRC32_SHIFT) &
+		ID_AA64ISAR0_CRC32_MASK) != 0U;
+}
+
 static inline bool is_armv8_2_ttcnp_present(void)
 {
 	return ((read_id_aa64mmfr2_el1() >> ID_AA64MMFR2_EL1_CNP_SHIFT) &
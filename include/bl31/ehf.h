@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -10,6 +10,7 @@
 #ifndef __ASSEMBLER__
 
 #include <cdefs.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <lib/utils_def.h>
@@ -62,6 +63,45 @@ typedef struct {
 	uint8_t ns_pri_mask;
 } __aligned(sizeof(uint64_t)) pe_exc_data_t;
 
+/* Events recorded in the per-CPU trace buffers */
+#define EHF_TRACE_ACTIVATE	U(1)
+#define EHF_TRACE_DEACTIVATE	U(2)
+#define EHF_TRACE_PREEMPT	U(3)
+
+#if EHF_TRACE
+
+/* Priority reported when no priority level was active */
+#define EHF_TRACE_NO_PRI	U(0xff)
+
+/* Number of events kept for each CPU. Must be a power of 2. */
+#ifndef EHF_TRACE_ENTRIES
+#define EHF_TRACE_ENTRIES	U(64)
+#endif
+
+/*
+ * An event of the trace. 'priority' is the priority that was activated or
+ * deactivated, or the running priority of the EL3 interrupt 'intr_raw' that
+ * was taken. 'prev_priority' is the highest active priority before the event.
+ */
+typedef struct ehf_trace_entry {
+	uint64_t timestamp;
+	uint32_t intr_raw;
+	uint8_t event;
+	uint8_t priority;
+	uint8_t prev_priority;
+	uint8_t reserved;
+} ehf_trace_entry_t;
+
+/*
+ * Trace buffer of a CPU. 'count' is the total number of events recorded, the
+ * last one being at index (count - 1) % EHF_TRACE_ENTRIES.
+ */
+typedef struct ehf_trace_cpu {
+	uint64_t count;
+	ehf_trace_entry_t entries[EHF_TRACE_ENTRIES];
+} ehf_trace_cpu_t;
+#endif /* EHF_TRACE */
+
 typedef int (*ehf_handler_t)(uint32_t intr_raw, uint32_t flags, void *handle,
 		void *cookie);
 
@@ -86,6 +126,9 @@ void ehf_deactivate_priority(unsigned int priority);
 void ehf_register_priority_handler(unsigned int pri, ehf_handler_t handler);
 void ehf_allow_ns_preemption(uint64_t preempt_ret_code);
 unsigned int ehf_is_ns_preemption_allowed(void);
+#if EHF_TRACE
+const ehf_trace_cpu_t *ehf_trace_get(size_t *size);
+#endif
 
 #endif /* __ASSEMBLER__ */
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -158,6 +158,14 @@ typedef struct meminfo {
  ******************************************************************************/
 int load_auth_image(unsigned int image_id, image_info_t *image_data);
 
+/*
+ * I/O session spanning several calls to load_auth_image(). Device
+ * connections opened while a session is active are kept open and closed
+ * once by bl_io_session_end().
+ */
+void bl_io_session_begin(void);
+void bl_io_session_end(void);
+
 #if TRUSTED_BOARD_BOOT && defined(DYN_DISABLE_AUTH)
 /*
  * API to dynamically disable authentication. Only meant for development
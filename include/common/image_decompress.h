@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2018-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,6 +7,7 @@
 #ifndef IMAGE_DECOMPRESS_H
 #define IMAGE_DECOMPRESS_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -16,9 +17,32 @@ typedef int (decompressor_t)(uintptr_t *in_buf, size_t in_len,
 			     uintptr_t *out_buf, size_t out_len,
 			     uintptr_t work_buf, size_t work_len);
 
+/*
+ * Decompressor fed with the compressed data in chunks. init() starts
+ * decompressing to 'out_buf', update() consumes the next chunk and finish()
+ * returns the end of the output.
+ */
+typedef struct decompressor_stream {
+	int (*init)(uintptr_t out_buf, size_t out_len,
+		    uintptr_t work_buf, size_t work_len);
+	int (*update)(uintptr_t in_buf, size_t in_len);
+	int (*finish)(uintptr_t *out_buf);
+} decompressor_stream_t;
+
 void image_decompress_init(uintptr_t buf_base, uint32_t buf_size,
 			   decompressor_t *decompressor);
 void image_decompress_prepare(struct image_info *info);
 int image_decompress(struct image_info *info);
 
+#if IMAGE_DECOMPRESS_STREAM
+void image_decompress_stream_init(uintptr_t buf_base, uint32_t buf_size,
+				  const decompressor_stream_t *decompressor);
+void image_decompress_prepare_stream(unsigned int image_id,
+				     struct image_info *info);
+bool image_decompress_stream_pending(unsigned int image_id);
+void image_decompress_stream_abort(unsigned int image_id);
+int image_decompress_stream_read(uintptr_t image_handle, size_t image_size,
+				 size_t *bytes_read);
+#endif
+
 #endif /* IMAGE_DECOMPRESS_H */
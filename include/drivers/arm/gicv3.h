@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -423,9 +423,23 @@ static inline void gicv3_end_of_interrupt(unsigned int id)
  * specific information. If this not the case, the platform port must provide a
  * hash function. Otherwise, the "Processor Number" field will be used to access
  * the array elements.
+ *
+ * The 'unused_spi_ranges' field is a pointer to an array of (E)SPI ranges that
+ * the platform does not use. This is an optional field. The Distributor
+ * registers of the blocks of 32 (E)SPIs that lie entirely within one of these
+ * ranges are neither saved nor restored across system suspend, so a platform
+ * with a sparse interrupt map can shorten the sequences.
+ *
+ * The 'unused_spi_ranges_num' field contains the number of entries in the
+ * 'unused_spi_ranges' array.
  ******************************************************************************/
 typedef unsigned int (*mpidr_hash_fn)(u_register_t mpidr);
 
+typedef struct gicv3_intr_range {
+	unsigned int first;
+	unsigned int last;
+} gicv3_intr_range_t;
+
 typedef struct gicv3_driver_data {
 	uintptr_t gicd_base;
 	uintptr_t gicr_base;
@@ -434,6 +448,8 @@ typedef struct gicv3_driver_data {
 	unsigned int rdistif_num;
 	uintptr_t *rdistif_base_addrs;
 	mpidr_hash_fn mpidr_to_core_pos;
+	const gicv3_intr_range_t *unused_spi_ranges;
+	unsigned int unused_spi_ranges_num;
 } gicv3_driver_data_t;
 
 typedef struct gicv3_redist_ctx {
@@ -484,6 +500,7 @@ typedef struct gicv3_its_ctx {
  ******************************************************************************/
 void gicv3_driver_init(const gicv3_driver_data_t *plat_driver_data);
 int gicv3_rdistif_probe(const uintptr_t gicr_frame);
+void gicv3_rdistif_probe_all(const uintptr_t gicr_frame);
 void gicv3_distif_init(void);
 void gicv3_rdistif_init(unsigned int proc_num);
 void gicv3_rdistif_on(unsigned int proc_num);
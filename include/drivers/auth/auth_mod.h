@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -51,6 +51,16 @@ int auth_mod_get_parent_id(unsigned int img_id, unsigned int *parent_id);
 int auth_mod_verify_img(unsigned int img_id,
 			void *img_ptr,
 			unsigned int img_len);
+unsigned int auth_mod_get_cache_hits(void);
+#if MEASURED_BOOT
+int auth_mod_get_img_digest(unsigned int img_id, uintptr_t base, size_t size,
+			    unsigned int alg, unsigned char *digest,
+			    unsigned int digest_len);
+#endif
+#if STREAM_HASH_AUTH
+int auth_mod_stream_hash_begin(unsigned int img_id);
+void auth_mod_stream_hash_update(const void *data_ptr, unsigned int data_len);
+#endif
 
 /* Macro to register a CoT defined as an array of auth_img_desc_t pointers */
 #define REGISTER_COT(_cot) \
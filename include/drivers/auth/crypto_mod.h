@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -51,6 +51,13 @@ typedef struct crypto_lib_desc_s {
 	/* Calculate a hash. Return hash value */
 	int (*calc_hash)(unsigned int alg, void *data_ptr,
 			 unsigned int data_len, unsigned char *output);
+
+	/* Extract the algorithm, in the same encoding as for calc_hash(), and
+	 * the hash value of a DigestInfo. Return one of the
+	 * 'enum crypto_ret_value' options */
+	int (*get_digest)(void *digest_info_ptr, unsigned int digest_info_len,
+			  unsigned int *alg, void **digest_ptr,
+			  unsigned int *digest_len);
 #endif /* MEASURED_BOOT */
 
 	/*
@@ -81,16 +88,20 @@ int crypto_mod_auth_decrypt(enum crypto_dec_algo dec_algo, void *data_ptr,
 #if MEASURED_BOOT
 int crypto_mod_calc_hash(unsigned int alg, void *data_ptr,
 			 unsigned int data_len, unsigned char *output);
+int crypto_mod_get_digest(void *digest_info_ptr, unsigned int digest_info_len,
+			  unsigned int *alg, void **digest_ptr,
+			  unsigned int *digest_len);
 
 /* Macro to register a cryptographic library */
 #define REGISTER_CRYPTO_LIB(_name, _init, _verify_signature, _verify_hash, \
-			    _calc_hash, _auth_decrypt) \
+			    _calc_hash, _get_digest, _auth_decrypt) \
 	const crypto_lib_desc_t crypto_lib_desc = { \
 		.name = _name, \
 		.init = _init, \
 		.verify_signature = _verify_signature, \
 		.verify_hash = _verify_hash, \
 		.calc_hash = _calc_hash, \
+		.get_digest = _get_digest, \
 		.auth_decrypt = _auth_decrypt \
 	}
 #else
@@ -107,4 +118,92 @@ int crypto_mod_calc_hash(unsigned int alg, void *data_ptr,
 
 extern const crypto_lib_desc_t crypto_lib_desc;
 
+#if STREAM_HASH_AUTH
+/*
+ * Optional descriptor for libraries able to verify a hash incrementally, so
+ * that an image can be hashed while it is being loaded. Only one stream can
+ * be in progress at a time; starting a new one discards the previous one.
+ * Libraries without this support register NULL handlers, and the images are
+ * then hashed once loaded.
+ */
+typedef struct crypto_lib_hash_stream_desc_s {
+	/* Start a stream that will be matched against the given DigestInfo.
+	 * Return one of the 'enum crypto_ret_value' options */
+	int (*verify_hash_init)(void *digest_info_ptr,
+				unsigned int digest_info_len);
+
+	/* Feed data to the stream. Return one of the
+	 * 'enum crypto_ret_value' options */
+	int (*verify_hash_update)(const void *data_ptr, unsigned int data_len);
+
+	/* Finish the stream and compare the result with the DigestInfo given
+	 * to verify_hash_init(). Return one of the 'enum crypto_ret_value'
+	 * options */
+	int (*verify_hash_final)(void);
+} crypto_lib_hash_stream_desc_t;
+
+int crypto_mod_verify_hash_init(void *digest_info_ptr,
+				unsigned int digest_info_len);
+int crypto_mod_verify_hash_update(const void *data_ptr, unsigned int data_len);
+int crypto_mod_verify_hash_final(void);
+
+/* Macro to register the streaming hash support of a cryptographic library */
+#define REGISTER_CRYPTO_LIB_HASH_STREAM(_init, _update, _final) \
+	const crypto_lib_hash_stream_desc_t crypto_lib_hash_stream_desc = { \
+		.verify_hash_init = _init, \
+		.verify_hash_update = _update, \
+		.verify_hash_final = _final \
+	}
+
+extern const crypto_lib_hash_stream_desc_t crypto_lib_hash_stream_desc;
+#endif /* STREAM_HASH_AUTH */
+
+#if STREAM_DECRYPTION
+/*
+ * Size of the blocks of the decryption algorithms. Except for the last one,
+ * the data fed to a decryption stream must be a multiple of this size.
+ */
+#define CRYPTO_DEC_BLOCK_SIZE		16U
+
+/*
+ * Optional descriptor for libraries able to decrypt data incrementally, so
+ * that an image can be decrypted while it is being read. The data is
+ * decrypted in place. Only one stream can be in progress at a time; starting
+ * a new one discards the previous one.
+ */
+typedef struct crypto_lib_dec_stream_desc_s {
+	/* Start a stream with the given key and IV. Return one of the
+	 * 'enum crypto_ret_value' options */
+	int (*auth_decrypt_init)(enum crypto_dec_algo dec_algo,
+				 const void *key, unsigned int key_len,
+				 unsigned int key_flags, const void *iv,
+				 unsigned int iv_len);
+
+	/* Decrypt data in place. Return one of the
+	 * 'enum crypto_ret_value' options */
+	int (*auth_decrypt_update)(void *data_ptr, size_t len);
+
+	/* Finish the stream and check the authentication tag. Return one of
+	 * the 'enum crypto_ret_value' options */
+	int (*auth_decrypt_final)(const void *tag, unsigned int tag_len);
+} crypto_lib_dec_stream_desc_t;
+
+int crypto_mod_auth_decrypt_init(enum crypto_dec_algo dec_algo,
+				 const void *key, unsigned int key_len,
+				 unsigned int key_flags, const void *iv,
+				 unsigned int iv_len);
+int crypto_mod_auth_decrypt_update(void *data_ptr, size_t len);
+int crypto_mod_auth_decrypt_final(const void *tag, unsigned int tag_len);
+
+/* Macro to register the streaming decryption support of a library */
+#define REGISTER_CRYPTO_LIB_DEC_STREAM(_init, _update, _final) \
+	const crypto_lib_dec_stream_desc_t crypto_lib_dec_stream_desc = { \
+		.auth_decrypt_init = _init, \
+		.auth_decrypt_update = _update, \
+		.auth_decrypt_final = _final \
+	}
+
+extern const crypto_lib_dec_stream_desc_t crypto_lib_dec_stream_desc;
+#endif /* STREAM_DECRYPTION */
+
 #endif /* CRYPTO_MOD_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -19,10 +19,26 @@ typedef struct io_block_dev_spec {
 	io_block_spec_t	buffer;
 	io_block_ops_t	ops;
 	size_t		block_size;
+	/*
+	 * Optional read cache, only used if the platform defines
+	 * IO_BLOCK_CACHE_MAX_LINES. The cache buffer is split in lines of
+	 * cache_line_size bytes, each filled by a single read operation. It is
+	 * disabled when cache.length is 0.
+	 */
+	io_block_spec_t	cache;
+	size_t		cache_line_size;
+	/*
+	 * Largest read done straight into the caller's buffer instead of
+	 * through the bounce buffer, for block-aligned data. The low level
+	 * driver must then be able to read to any block-aligned destination.
+	 * 0 disables direct reads.
+	 */
+	size_t		max_direct_read;
 } io_block_dev_spec_t;
 
 struct io_dev_connector;
 
 int register_io_dev_block(const struct io_dev_connector **dev_con);
+void io_block_cache_invalidate(void);
 
 #endif /* IO_BLOCK_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,6 +7,9 @@
 #ifndef GPT_H
 #define GPT_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <drivers/partition/partition.h>
 
 #define PARTITION_TYPE_GPT		0xee
@@ -14,6 +17,13 @@
 #define GPT_ENTRY_OFFSET		(GPT_HEADER_OFFSET +		\
 					 PLAT_PARTITION_BLOCK_SIZE)
 #define GUID_LEN			16
+/* Size of the GPT header fields, without the padding of gpt_header_t */
+#define GPT_HEADER_SIZE			92
+/*
+ * Largest GPT entry array accepted. The whole array is read to check its CRC,
+ * so this bounds the reads a corrupt header can cause.
+ */
+#define GPT_MAX_ENTRIES			1024
 
 #define GPT_SIGNATURE			"EFI PART"
 
@@ -47,5 +57,6 @@ typedef struct gpt_header {
 } gpt_header_t;
 
 int parse_gpt_entry(gpt_entry_t *gpt_entry, partition_entry_t *entry);
+uint32_t gpt_crc32(uint32_t crc, const uint8_t *buf, size_t size);
 
 #endif /* GPT_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -94,6 +94,8 @@ typedef bakery_info_t bakery_lock_t;
 
 static inline void bakery_lock_init(bakery_lock_t *bakery) {}
 void bakery_lock_get(bakery_lock_t *bakery);
+void bakery_lock_get_range(bakery_lock_t *bakery, unsigned int first,
+			   unsigned int count);
 void bakery_lock_release(bakery_lock_t *bakery);
 
 #define DEFINE_BAKERY_LOCK(_name) bakery_lock_t _name __section("bakery_lock")
@@ -506,6 +506,17 @@ CASSERT(CTX_PAUTH_REGS_OFFSET == __builtin_offsetof(cpu_context_t, pauth_ctx), \
 void el1_sysregs_context_save(el1_sysregs_t *regs);
 void el1_sysregs_context_restore(el1_sysregs_t *regs);
 
+#if CTX_LAZY_SYSREGS
+#if NS_TIMER_SWITCH
+void el1_timer_sysregs_context_save(el1_sysregs_t *regs);
+void el1_timer_sysregs_context_restore(el1_sysregs_t *regs);
+#endif
+#if CTX_INCLUDE_MTE_REGS
+void el1_mte_sysregs_context_save(el1_sysregs_t *regs);
+void el1_mte_sysregs_context_restore(el1_sysregs_t *regs);
+#endif
+#endif
+
 #if CTX_INCLUDE_EL2_REGS
 void el2_sysregs_context_save(el2_sysregs_t *regs);
 void el2_sysregs_context_restore(el2_sysregs_t *regs);
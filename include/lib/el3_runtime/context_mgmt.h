@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -52,6 +52,32 @@ void cm_write_scr_el3_bit(uint32_t security_state,
 void cm_set_next_eret_context(uint32_t security_state);
 u_register_t cm_get_scr_el3(uint32_t security_state);
 
+#if CTX_LAZY_SYSREGS
+/* Groups of lower EL system registers that are switched lazily */
+#define CM_SYSREGS_EL1		U(0)
+#define CM_SYSREGS_TIMER	U(1)
+#define CM_SYSREGS_MTE		U(2)
+#define CM_SYSREGS_EL2		U(3)
+#define CM_SYSREGS_GROUPS	U(4)
+#define CM_SYSREGS_BIT(_group)	BIT_32(_group)
+
+/* Number of times each group of system registers was switched on a CPU */
+typedef struct cm_sysregs_stats {
+	uint64_t saved[CM_SYSREGS_GROUPS];
+	uint64_t save_skipped[CM_SYSREGS_GROUPS];
+	uint64_t restored[CM_SYSREGS_GROUPS];
+	uint64_t restore_skipped[CM_SYSREGS_GROUPS];
+} cm_sysregs_stats_t;
+
+void cm_sysregs_set_unused(uint32_t security_state, unsigned int groups);
+void cm_sysregs_context_changed(const cpu_context_t *ctx);
+void cm_sysregs_reset_owners(void);
+const cm_sysregs_stats_t *cm_get_sysregs_stats(unsigned int cpu_idx);
+#if CTX_SYSREGS_BENCHMARK
+void cm_sysregs_benchmark(void);
+#endif
+#endif /* CTX_LAZY_SYSREGS */
+
 /* Inline definitions */
 
 /*******************************************************************************
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef MCS_LOCK_H
+#define MCS_LOCK_H
+
+/* Offsets of the queue node members for use in assembly */
+#define MCS_NODE_NEXT		0x0
+#define MCS_NODE_LOCKED		0x8
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+#include <lib/cassert.h>
+
+/*
+ * Queue node of an MCS lock. Each CPU waiting for or holding a lock owns one
+ * node, and spins on its own 'locked' flag rather than on the lock itself. A
+ * CPU holding several MCS locks at the same time needs one node per lock.
+ */
+typedef struct mcs_node {
+	struct mcs_node *volatile next;
+	volatile uint32_t locked;
+} mcs_node_t;
+
+/* The lock points to the last node in the queue, or is NULL when free */
+typedef struct mcs_lock {
+	mcs_node_t *volatile tail;
+} mcs_lock_t;
+
+CASSERT(MCS_NODE_NEXT == __builtin_offsetof(mcs_node_t, next),
+	assert_mcs_node_next_offset_mismatch);
+CASSERT(MCS_NODE_LOCKED == __builtin_offsetof(mcs_node_t, locked),
+	assert_mcs_node_locked_offset_mismatch);
+
+/*
+ * MCS locks rely on exclusive accesses, so they must only be used in Normal
+ * cacheable memory shared by CPUs which are all in the coherency domain.
+ */
+void mcs_lock_get(mcs_lock_t *lock, mcs_node_t *node);
+void mcs_lock_release(mcs_lock_t *lock, mcs_node_t *node);
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* MCS_LOCK_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -40,7 +40,12 @@
  */
 #define PMF_SMC_GET_TIMESTAMP_32	U(0x82000010)
 #define PMF_SMC_GET_TIMESTAMP_64	U(0xC2000010)
-#define PMF_NUM_SMC_CALLS		2
+#define PMF_SMC_GET_RT_SVC_HIST_32	U(0x82000011)
+#define PMF_SMC_GET_RT_SVC_HIST_64	U(0xC2000011)
+#define PMF_SMC_GET_PSCI_STAT_32	U(0x82000012)
+#define PMF_SMC_GET_PSCI_STAT_64	U(0xC2000012)
+#define PMF_NUM_SMC_CALLS		(2 + (2 * ENABLE_RT_SVC_HISTOGRAMS) + \
+					 (2 * PSCI_STAT_SNAPSHOT))
 
 /*
  * The macros below are used to identify
@@ -63,6 +68,8 @@ int pmf_get_timestamp_smc(unsigned int tid,
 		unsigned int flags,
 		unsigned long long *ts_value);
 int pmf_setup(void);
+int pmf_copy_to_ns_buf(u_register_t buf_pa, u_register_t buf_size,
+		size_t size, void (*fill)(void *dst));
 uintptr_t pmf_smc_handler(unsigned int smc_fid,
 		u_register_t x1,
 		u_register_t x2,
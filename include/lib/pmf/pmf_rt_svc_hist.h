@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PMF_RT_SVC_HIST_H
+#define PMF_RT_SVC_HIST_H
+
+#include <lib/utils_def.h>
+
+/*
+ * Each CPU has (1 << RT_SVC_HIST_FIDS_SHIFT) histograms for individual SMC
+ * function IDs, followed by one histogram for the calls whose function ID
+ * did not fit in the table.
+ */
+#ifndef RT_SVC_HIST_FIDS_SHIFT
+#define RT_SVC_HIST_FIDS_SHIFT		4
+#endif
+#define RT_SVC_HIST_MAX_FIDS		(U(1) << RT_SVC_HIST_FIDS_SHIFT)
+#define RT_SVC_HIST_ENTRIES		(RT_SVC_HIST_MAX_FIDS + U(1))
+
+/*
+ * Bucket 0 counts the calls that took less than one generic timer tick and
+ * bucket n counts the calls that took [2^(n-1), 2^n) ticks. The last bucket
+ * also counts all the longer calls.
+ */
+#define RT_SVC_HIST_BUCKETS		U(24)
+
+/* Function ID reported for the histogram of the calls not in the table */
+#define RT_SVC_HIST_FID_OTHER		U(0xFFFFFFFF)
+
+#define RT_SVC_HIST_VERSION		U(1)
+
+#ifndef __ASSEMBLER__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Layout of the block copied to the normal world: a header followed by
+ * 'num_cpus' arrays of 'num_entries' histograms, in core position order.
+ */
+typedef struct rt_svc_hist_hdr {
+	uint32_t version;
+	uint32_t num_cpus;
+	uint32_t num_entries;
+	uint32_t num_buckets;
+	uint64_t cntfrq;
+} rt_svc_hist_hdr_t;
+
+typedef struct rt_svc_hist_entry {
+	uint32_t fid;
+	uint32_t valid;
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint32_t buckets[RT_SVC_HIST_BUCKETS];
+} rt_svc_hist_entry_t;
+
+void pmf_rt_svc_hist_record(uint32_t smc_fid, uint64_t start);
+int pmf_rt_svc_hist_get_smc(u_register_t buf_pa, u_register_t buf_size,
+			    u_register_t *size);
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* PMF_RT_SVC_HIST_H */
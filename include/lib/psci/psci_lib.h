@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -12,6 +12,7 @@
 #ifndef __ASSEMBLER__
 
 #include <cdefs.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /*******************************************************************************
@@ -72,6 +73,25 @@ typedef struct psci_lib_args {
 		&& ((_p)->h.attr == 0)				\
 		&& ((_p)->mailbox_ep != NULL))
 
+/*
+ * Layout of the block written by psci_stat_snapshot(): this header, the MPIDR
+ * of each CPU as a uint64_t, then 'num_states' entries for each CPU followed
+ * by 'num_states' entries for each non CPU power domain.
+ */
+#define PSCI_STAT_SNAPSHOT_VERSION	U(1)
+
+typedef struct psci_stat_snapshot_hdr {
+	uint32_t version;
+	uint32_t num_cpus;
+	uint32_t num_non_cpu_pds;
+	uint32_t num_states;
+} psci_stat_snapshot_hdr_t;
+
+typedef struct psci_stat_snapshot_entry {
+	uint64_t residency;
+	uint64_t count;
+} psci_stat_snapshot_entry_t;
+
 /******************************************************************************
  * PSCI Library Interfaces
  *****************************************************************************/
@@ -91,6 +111,8 @@ void psci_prepare_next_non_secure_ctx(
 			  entry_point_info_t *next_image_info);
 int psci_stop_other_cores(unsigned int wait_ms,
 			  void (*stop_func)(u_register_t mpidr));
+size_t psci_stat_snapshot_size(void);
+void psci_stat_snapshot(void *dst);
 #endif /* __ASSEMBLER__ */
 
 #endif /* PSCI_LIB_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -11,18 +11,68 @@
 
 #include <stdint.h>
 
+#include <lib/utils_def.h>
+
 typedef struct spinlock {
 	volatile uint32_t lock;
+#if SPINLOCK_STATS
+	/*
+	 * Statistics, only updated by the owner of the lock. The maximum wait
+	 * is counted in generic timer ticks.
+	 */
+	uint32_t registered;
+	uint64_t acquisitions;
+	uint64_t contended;
+	uint64_t spins;
+	uint64_t max_wait;
+#endif
 } spinlock_t;
 
 void spin_lock(spinlock_t *lock);
 void spin_unlock(spinlock_t *lock);
 
+#if SPINLOCK_STATS
+/* Maximum number of locks whose statistics can be retrieved */
+#ifndef SPINLOCK_STATS_MAX_LOCKS
+#define SPINLOCK_STATS_MAX_LOCKS	64U
+#endif
+
+/* Function ID of the Arm SiP call returning the statistics of a lock */
+#define SPINLOCK_STATS_SMC_64		U(0xC2000040)
+#define SPINLOCK_STATS_NUM_SMC_CALLS	1
+#define is_spinlock_stats_fid(_fid)	((_fid) == SPINLOCK_STATS_SMC_64)
+
+/* Acquire a ticket lock, returning the number of wait loop iterations */
+unsigned int spin_lock_ticket(spinlock_t *lock);
+
+/*
+ * Acquire a lock and update its statistics. C code is redirected to it, while
+ * assembly callers keep the register-preserving spin_lock().
+ */
+void spin_lock_stats(spinlock_t *lock);
+#define spin_lock(lock)			spin_lock_stats(lock)
+
+int spinlock_stats_get(unsigned int idx, const spinlock_t **lock);
+uintptr_t spinlock_stats_smc_handler(unsigned int smc_fid,
+				     u_register_t x1,
+				     u_register_t x2,
+				     u_register_t x3,
+				     u_register_t x4,
+				     void *cookie,
+				     void *handle,
+				     u_register_t flags);
+#endif /* SPINLOCK_STATS */
+
 #else
 
 /* Spin lock definitions for use in assembly */
+#if SPINLOCK_STATS
+#define SPINLOCK_ASM_ALIGN	3
+#define SPINLOCK_ASM_SIZE	40
+#else
 #define SPINLOCK_ASM_ALIGN	2
 #define SPINLOCK_ASM_SIZE	4
+#endif
 
 #endif
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -50,9 +50,10 @@ int mem_region_in_array_chk(mem_region_t *tbl, size_t nregions,
 /*
  * Fill a region of normal memory of size "length" in bytes with zero bytes.
  *
- * WARNING: This function can only operate on normal memory. This means that
- *          the MMU must be enabled when using this function. Otherwise, use
- *          zeromem.
+ * WARNING: This function can only operate on normal memory. The DC ZVA
+ *          instruction is only used when the MMU is enabled, so it is safe
+ *          to call with the MMU disabled, but it is then no faster than
+ *          zeromem. It must never be used on Device memory.
  */
 void zero_normalmem(void *mem, u_register_t length);
 
@@ -69,6 +70,12 @@ void zero_normalmem(void *mem, u_register_t length);
  */
 void zeromem(void *mem, u_register_t length);
 
+/*
+ * Measure and print the throughput of zeromem, zero_normalmem and memset.
+ * Only available when ZERO_MEM_BENCHMARK is set.
+ */
+void zero_mem_benchmark(void);
+
 /*
  * Utility function to return the address of a symbol. By default, the
  * compiler generates adr/adrp instruction pair to return the reference
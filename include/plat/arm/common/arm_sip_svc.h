@@ -18,6 +18,10 @@
 
 /* PMF_SMC_GET_TIMESTAMP_32		0x82000010 */
 /* PMF_SMC_GET_TIMESTAMP_64		0xC2000010 */
+/* PMF_SMC_GET_RT_SVC_HIST_32		0x82000011 */
+/* PMF_SMC_GET_RT_SVC_HIST_64		0xC2000011 */
+/* PMF_SMC_GET_PSCI_STAT_32		0x82000012 */
+/* PMF_SMC_GET_PSCI_STAT_64		0xC2000012 */
 
 /* Function ID for requesting state switch of lower EL */
 #define ARM_SIP_SVC_EXE_STATE_SWITCH	U(0x82000020)
@@ -25,6 +29,8 @@
 /* DEBUGFS_SMC_32			0x82000030U */
 /* DEBUGFS_SMC_64			0xC2000030U */
 
+/* SPINLOCK_STATS_SMC_64		0xC2000040U */
+
 /*
  * Arm Ethos-N NPU SiP SMC function IDs
  * 0xC2000050-0xC200005F
@@ -7,6 +7,7 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <lib/psci/psci.h>
@@ -143,6 +144,14 @@ void plat_sdei_handle_masked_trigger(uint64_t mpidr, unsigned int intr);
 void plat_ea_handler(unsigned int ea_reason, uint64_t syndrome, void *cookie,
 		void *handle, uint64_t flags);
 
+/*
+ * The following function is mandatory when the PMF calls that copy data to a
+ * normal world buffer are enabled.
+ */
+#if ENABLE_RT_SVC_HISTOGRAMS || PSCI_STAT_SNAPSHOT
+bool plat_is_ns_buffer(unsigned long long base, size_t size);
+#endif
+
 /*
  * The following function is mandatory when the
  * firmware update feature is used.
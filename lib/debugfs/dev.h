@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2021, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -34,6 +34,7 @@ enum {
 	DEV_ROOT_QDEV,
 	DEV_ROOT_QFIP,
 	DEV_ROOT_QBLOBS,
+	DEV_ROOT_QEHFTRACE,
 	DEV_ROOT_QBLOBCTL,
 	DEV_ROOT_QPSCI
 };
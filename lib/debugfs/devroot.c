@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2021, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <bl31/ehf.h>
 #include <common/debug.h>
 #include <lib/debugfs.h>
 
@@ -21,6 +22,9 @@ static const dirtab_t dirtab[] = {
 };
 
 static const dirtab_t devfstab[] = {
+#if EHF_TRACE
+	{"ehf-trace", DEV_ROOT_QEHFTRACE, 0, O_READ}
+#endif
 };
 
 /*******************************************************************************
@@ -72,6 +76,17 @@ static int rootread(chan_t *channel, void *buf, int size)
 		return dirread(channel, dir, NULL, 0, rootgen);
 	}
 
+#if EHF_TRACE
+	if (channel->qid == DEV_ROOT_QEHFTRACE) {
+		const ehf_trace_cpu_t *trace;
+		size_t trace_size;
+
+		trace = ehf_trace_get(&trace_size);
+		return buf_to_channel(channel, buf, (void *)trace, size,
+				      (long)trace_size);
+	}
+#endif
+
 	/* Only makes sense when using debug language */
 	assert(channel->qid != DEV_ROOT_QBLOBCTL);
 
@@ -24,6 +24,7 @@
 #include <lib/extensions/sve.h>
 #include <lib/extensions/twed.h>
 #include <lib/utils.h>
+#include <plat/common/platform.h>
 
 
 /*******************************************************************************
@@ -47,6 +48,276 @@ void __init cm_init(void)
 	 */
 }
 
+#if CTX_LAZY_SYSREGS
+/*******************************************************************************
+ * Lazy switching of the lower EL system registers. Each CPU records, for every
+ * group of registers, the context whose values the registers hold.
+ *
+ * EL3 cannot tell whether a lower EL has written these registers, so a world
+ * that uses a group always has it saved when it is switched out and restored
+ * when it is switched in. A group that a world does not use is neither saved
+ * nor restored for it: the registers keep the values of their owner, the other
+ * world, which then finds them in place and skips its own restore. A world
+ * does not use a group when SCR_EL3 prevents it from accessing it, or when its
+ * dispatcher has declared so with cm_sysregs_set_unused().
+ ******************************************************************************/
+typedef struct cm_sysregs_cpu {
+	const cpu_context_t	*owner[CM_SYSREGS_GROUPS];
+	cm_sysregs_stats_t	stats;
+} __aligned(CACHE_WRITEBACK_GRANULE) cm_sysregs_cpu_t;
+
+static cm_sysregs_cpu_t cm_sysregs_cpu[PLATFORM_CORE_COUNT];
+
+/* Groups declared as unused by each security state */
+static unsigned int cm_sysregs_unused[2];
+
+static bool cm_sysregs_used(const cpu_context_t *ctx, uint32_t security_state,
+			    unsigned int group)
+{
+	u_register_t scr_el3 = read_ctx_reg(get_el3state_ctx(ctx), CTX_SCR_EL3);
+
+	if ((cm_sysregs_unused[security_state] & CM_SYSREGS_BIT(group)) != 0U) {
+		return false;
+	}
+
+	/* Accesses to the MTE registers trap to EL3 when SCR_EL3.ATA is 0 */
+	if (group == CM_SYSREGS_MTE) {
+		return (scr_el3 & SCR_ATA_BIT) != 0U;
+	}
+
+	/* The Secure world only has an EL2 when SCR_EL3.EEL2 is set */
+	if ((group == CM_SYSREGS_EL2) && (security_state == SECURE)) {
+		return (scr_el3 & SCR_EEL2_BIT) != 0U;
+	}
+
+	return true;
+}
+
+static void cm_sysregs_group_save(cpu_context_t *ctx, unsigned int group)
+{
+	switch (group) {
+	case CM_SYSREGS_EL1:
+		el1_sysregs_context_save(get_el1_sysregs_ctx(ctx));
+		break;
+#if NS_TIMER_SWITCH
+	case CM_SYSREGS_TIMER:
+		el1_timer_sysregs_context_save(get_el1_sysregs_ctx(ctx));
+		break;
+#endif
+#if CTX_INCLUDE_MTE_REGS
+	case CM_SYSREGS_MTE:
+		el1_mte_sysregs_context_save(get_el1_sysregs_ctx(ctx));
+		break;
+#endif
+#if CTX_INCLUDE_EL2_REGS
+	case CM_SYSREGS_EL2:
+		el2_sysregs_context_save(get_el2_sysregs_ctx(ctx));
+		break;
+#endif
+	default:
+		assert(false);
+		break;
+	}
+}
+
+static void cm_sysregs_group_restore(cpu_context_t *ctx, unsigned int group)
+{
+	switch (group) {
+	case CM_SYSREGS_EL1:
+		el1_sysregs_context_restore(get_el1_sysregs_ctx(ctx));
+		break;
+#if NS_TIMER_SWITCH
+	case CM_SYSREGS_TIMER:
+		el1_timer_sysregs_context_restore(get_el1_sysregs_ctx(ctx));
+		break;
+#endif
+#if CTX_INCLUDE_MTE_REGS
+	case CM_SYSREGS_MTE:
+		el1_mte_sysregs_context_restore(get_el1_sysregs_ctx(ctx));
+		break;
+#endif
+#if CTX_INCLUDE_EL2_REGS
+	case CM_SYSREGS_EL2:
+		el2_sysregs_context_restore(get_el2_sysregs_ctx(ctx));
+		break;
+#endif
+	default:
+		assert(false);
+		break;
+	}
+}
+
+static void cm_sysregs_save(cpu_context_t *ctx, uint32_t security_state,
+			    unsigned int group)
+{
+	cm_sysregs_cpu_t *cpu = &cm_sysregs_cpu[plat_my_core_pos()];
+
+	/*
+	 * The world may have changed any register it uses, so those are
+	 * always saved.
+	 */
+	if (!cm_sysregs_used(ctx, security_state, group)) {
+		cpu->stats.save_skipped[group]++;
+		return;
+	}
+
+	cm_sysregs_group_save(ctx, group);
+	cpu->owner[group] = ctx;
+	cpu->stats.saved[group]++;
+}
+
+static void cm_sysregs_restore(cpu_context_t *ctx, uint32_t security_state,
+			       unsigned int group)
+{
+	cm_sysregs_cpu_t *cpu = &cm_sysregs_cpu[plat_my_core_pos()];
+
+	if ((cpu->owner[group] == ctx) ||
+	    !cm_sysregs_used(ctx, security_state, group)) {
+		cpu->stats.restore_skipped[group]++;
+		return;
+	}
+
+	cm_sysregs_group_restore(ctx, group);
+	cpu->owner[group] = ctx;
+	cpu->stats.restored[group]++;
+}
+
+/*******************************************************************************
+ * Declare the groups of system registers, as a mask of CM_SYSREGS_BIT() values,
+ * that the world of 'security_state' never accesses. They are then left with
+ * the values of the other world while this world runs. This must be called
+ * before the world first runs, and the world must really leave them alone.
+ ******************************************************************************/
+void cm_sysregs_set_unused(uint32_t security_state, unsigned int groups)
+{
+	assert(sec_state_is_valid(security_state));
+	assert((groups & ~(CM_SYSREGS_BIT(CM_SYSREGS_GROUPS) - 1U)) == 0U);
+
+	cm_sysregs_unused[security_state] = groups;
+}
+
+/*******************************************************************************
+ * Forget that any CPU holds the system registers of 'ctx', so that they are
+ * restored the next time the context is. This must be called after changing
+ * the saved EL1 or EL2 system registers of a context.
+ ******************************************************************************/
+void cm_sysregs_context_changed(const cpu_context_t *ctx)
+{
+	unsigned int cpu, group;
+
+	for (cpu = 0U; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		for (group = 0U; group < CM_SYSREGS_GROUPS; group++) {
+			if (cm_sysregs_cpu[cpu].owner[group] == ctx) {
+				cm_sysregs_cpu[cpu].owner[group] = NULL;
+			}
+		}
+	}
+}
+
+/*******************************************************************************
+ * Forget the owners of the system registers of the calling CPU. This must be
+ * called when the CPU comes out of a power down state, as the registers have
+ * lost their values.
+ ******************************************************************************/
+void cm_sysregs_reset_owners(void)
+{
+	cm_sysregs_cpu_t *cpu = &cm_sysregs_cpu[plat_my_core_pos()];
+
+	zeromem(cpu->owner, sizeof(cpu->owner));
+}
+
+const cm_sysregs_stats_t *cm_get_sysregs_stats(unsigned int cpu_idx)
+{
+	assert(cpu_idx < PLATFORM_CORE_COUNT);
+
+	return &cm_sysregs_cpu[cpu_idx].stats;
+}
+
+#if CTX_SYSREGS_BENCHMARK
+#define CM_SYSREGS_BENCHMARK_ITERATIONS	U(1024)
+
+static const char *const cm_sysregs_group_names[CM_SYSREGS_GROUPS] = {
+	[CM_SYSREGS_EL1] = "EL1",
+	[CM_SYSREGS_TIMER] = "NS timer",
+	[CM_SYSREGS_MTE] = "MTE",
+	[CM_SYSREGS_EL2] = "EL2",
+};
+
+/* Convert the timer ticks taken by the benchmark loop into ns per iteration */
+static unsigned long long cm_sysregs_bench_ns(uint64_t ticks, uint64_t freq)
+{
+	return (unsigned long long)((ticks * 1000000000ULL) /
+			(freq * CM_SYSREGS_BENCHMARK_ITERATIONS));
+}
+
+/*******************************************************************************
+ * Measure how long it takes to save, restore and skip the restore of each
+ * group of system registers on the calling CPU. The registers are saved to and
+ * restored from a scratch context, so their values are left unchanged. The
+ * generic timer is used as the time base because the cycle counter does not
+ * count at EL3.
+ ******************************************************************************/
+void cm_sysregs_benchmark(void)
+{
+	static cpu_context_t bench_ctx;
+	cm_sysregs_cpu_t *cpu = &cm_sysregs_cpu[plat_my_core_pos()];
+	const cpu_context_t *owner[CM_SYSREGS_GROUPS];
+	cm_sysregs_stats_t stats = cpu->stats;
+	uint64_t freq = read_cntfrq_el0();
+	uint64_t start, save, restore, skip;
+	unsigned int group, i;
+
+	(void)memcpy(owner, cpu->owner, sizeof(owner));
+	write_ctx_reg(get_el3state_ctx(&bench_ctx), CTX_SCR_EL3,
+		      read_scr() | SCR_ATA_BIT);
+
+	INFO("System register switch benchmark (ns per call):\n");
+	for (group = 0U; group < CM_SYSREGS_GROUPS; group++) {
+		if (((group == CM_SYSREGS_TIMER) && (NS_TIMER_SWITCH == 0)) ||
+		    ((group == CM_SYSREGS_MTE) && (CTX_INCLUDE_MTE_REGS == 0)) ||
+		    ((group == CM_SYSREGS_EL2) &&
+		     ((CTX_INCLUDE_EL2_REGS == 0) ||
+		      (el_implemented(2) == EL_IMPL_NONE)))) {
+			continue;
+		}
+
+		isb();
+		start = read_cntpct_el0();
+		for (i = 0U; i < CM_SYSREGS_BENCHMARK_ITERATIONS; i++) {
+			cm_sysregs_save(&bench_ctx, NON_SECURE, group);
+		}
+		isb();
+		save = read_cntpct_el0() - start;
+
+		start = read_cntpct_el0();
+		for (i = 0U; i < CM_SYSREGS_BENCHMARK_ITERATIONS; i++) {
+			cpu->owner[group] = NULL;
+			cm_sysregs_restore(&bench_ctx, NON_SECURE, group);
+		}
+		isb();
+		restore = read_cntpct_el0() - start;
+
+		start = read_cntpct_el0();
+		for (i = 0U; i < CM_SYSREGS_BENCHMARK_ITERATIONS; i++) {
+			cm_sysregs_restore(&bench_ctx, NON_SECURE, group);
+		}
+		isb();
+		skip = read_cntpct_el0() - start;
+
+		INFO("  %s: save %llu, restore %llu, skipped restore %llu\n",
+		     cm_sysregs_group_names[group],
+		     cm_sysregs_bench_ns(save, freq),
+		     cm_sysregs_bench_ns(restore, freq),
+		     cm_sysregs_bench_ns(skip, freq));
+	}
+
+	/* Leave no trace of the benchmark in the switch state */
+	(void)memcpy(cpu->owner, owner, sizeof(owner));
+	cpu->stats = stats;
+}
+#endif /* CTX_SYSREGS_BENCHMARK */
+#endif /* CTX_LAZY_SYSREGS */
+
 /*******************************************************************************
  * The following function initializes the cpu_context 'ctx' for
  * first use, and sets the initial entrypoint state as specified by the
@@ -77,6 +348,11 @@ void cm_setup_context(cpu_context_t *ctx, const entry_point_info_t *ep)
 	/* Clear any residual register values from the context */
 	zeromem(ctx, sizeof(*ctx));
 
+#if CTX_LAZY_SYSREGS
+	/* No CPU holds the register values of the new context */
+	cm_sysregs_context_changed(ctx);
+#endif
+
 	/*
 	 * SCR_EL3 was initialised during reset sequence in macro
 	 * el3_arch_init_common. This code modifies the SCR_EL3 fields that
@@ -387,6 +663,10 @@ void cm_prepare_el3_exit(uint32_t security_state)
 	assert(ctx != NULL);
 
 	if (security_state == NON_SECURE) {
+#if CTX_LAZY_SYSREGS
+		/* The EL2 registers are about to be written directly */
+		cm_sysregs_cpu[plat_my_core_pos()].owner[CM_SYSREGS_EL2] = NULL;
+#endif
 		scr_el3 = read_ctx_reg(get_el3state_ctx(ctx),
 						 CTX_SCR_EL3);
 		if ((scr_el3 & SCR_HCE_BIT) != 0U) {
@@ -604,7 +884,11 @@ void cm_el2_sysregs_context_save(uint32_t security_state)
 		ctx = cm_get_context(security_state);
 		assert(ctx != NULL);
 
+#if CTX_LAZY_SYSREGS
+		cm_sysregs_save(ctx, security_state, CM_SYSREGS_EL2);
+#else
 		el2_sysregs_context_save(get_el2_sysregs_ctx(ctx));
+#endif
 	}
 }
 
@@ -626,7 +910,11 @@ void cm_el2_sysregs_context_restore(uint32_t security_state)
 		ctx = cm_get_context(security_state);
 		assert(ctx != NULL);
 
+#if CTX_LAZY_SYSREGS
+		cm_sysregs_restore(ctx, security_state, CM_SYSREGS_EL2);
+#else
 		el2_sysregs_context_restore(get_el2_sysregs_ctx(ctx));
+#endif
 	}
 }
 #endif /* CTX_INCLUDE_EL2_REGS */
@@ -643,7 +931,17 @@ void cm_el1_sysregs_context_save(uint32_t security_state)
 	ctx = cm_get_context(security_state);
 	assert(ctx != NULL);
 
+#if CTX_LAZY_SYSREGS
+	cm_sysregs_save(ctx, security_state, CM_SYSREGS_EL1);
+#if NS_TIMER_SWITCH
+	cm_sysregs_save(ctx, security_state, CM_SYSREGS_TIMER);
+#endif
+#if CTX_INCLUDE_MTE_REGS
+	cm_sysregs_save(ctx, security_state, CM_SYSREGS_MTE);
+#endif
+#else
 	el1_sysregs_context_save(get_el1_sysregs_ctx(ctx));
+#endif
 
 #if IMAGE_BL31
 	if (security_state == SECURE)
@@ -660,7 +958,17 @@ void cm_el1_sysregs_context_restore(uint32_t security_state)
 	ctx = cm_get_context(security_state);
 	assert(ctx != NULL);
 
+#if CTX_LAZY_SYSREGS
+	cm_sysregs_restore(ctx, security_state, CM_SYSREGS_EL1);
+#if NS_TIMER_SWITCH
+	cm_sysregs_restore(ctx, security_state, CM_SYSREGS_TIMER);
+#endif
+#if CTX_INCLUDE_MTE_REGS
+	cm_sysregs_restore(ctx, security_state, CM_SYSREGS_MTE);
+#endif
+#else
 	el1_sysregs_context_restore(get_el1_sysregs_ctx(ctx));
+#endif
 
 #if IMAGE_BL31
 	if (security_state == SECURE)
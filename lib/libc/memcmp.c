@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2013-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 int memcmp(const void *s1, const void *s2, size_t len)
@@ -14,6 +15,28 @@ int memcmp(const void *s1, const void *s2, size_t len)
 	unsigned char sc;
 	unsigned char dc;
 
+	/*
+	 * If both buffers can be aligned together, skip over equal 64-bit
+	 * words. The first differing word is then compared byte-per-byte
+	 * below, which keeps the result independent of endianness.
+	 */
+	if ((((uintptr_t)s ^ (uintptr_t)d) & 7U) == 0U) {
+		while ((len > 0U) && (((uintptr_t)s & 7U) != 0U)) {
+			sc = *s++;
+			dc = *d++;
+			if (sc - dc)
+				return (sc - dc);
+			len--;
+		}
+
+		while ((len >= 8U) &&
+		       (*(const uint64_t *)s == *(const uint64_t *)d)) {
+			s += 8;
+			d += 8;
+			len -= 8U;
+		}
+	}
+
 	while (len--) {
 		sc = *s++;
 		dc = *d++;
@@ -1,19 +1,54 @@
 /*
- * Copyright (c) 2013-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 void *memcpy(void *dst, const void *src, size_t len)
 {
-	const char *s = src;
-	char *d = dst;
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	const uint64_t *s64;
+	uint64_t *d64;
 
-	while (len--)
+	/*
+	 * Words can only be used if both pointers can reach a 64-bit
+	 * boundary together.
+	 */
+	if ((((uintptr_t)d ^ (uintptr_t)s) & 7U) == 0U) {
+		/* Handle the first part, until the pointers become aligned. */
+		while ((len > 0U) && (((uintptr_t)d & 7U) != 0U)) {
+			*d++ = *s++;
+			len--;
+		}
+
+		/* Use 64-bit copies for as long as possible. */
+		s64 = (const uint64_t *)s;
+		d64 = (uint64_t *)d;
+		for (; len >= 32U; len -= 32U) {
+			d64[0] = s64[0];
+			d64[1] = s64[1];
+			d64[2] = s64[2];
+			d64[3] = s64[3];
+			d64 += 4;
+			s64 += 4;
+		}
+		for (; len >= 8U; len -= 8U) {
+			*d64++ = *s64++;
+		}
+
+		s = (const uint8_t *)s64;
+		d = (uint8_t *)d64;
+	}
+
+	/* Handle the remaining part byte-per-byte. */
+	while (len-- > 0U) {
 		*d++ = *s++;
+	}
 
 	return dst;
 }
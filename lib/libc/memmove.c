@@ -1,9 +1,10 @@
 /*
- * Copyright (c) 2013-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <stdint.h>
 #include <string.h>
 
 void *memmove(void *dst, const void *src, size_t len)
@@ -21,11 +22,36 @@ void *memmove(void *dst, const void *src, size_t len)
 		return memcpy(dst, src, len);
 	} else {
 		/* copy backwards... */
-		const char *end = dst;
-		const char *s = (const char *)src + len;
-		char *d = (char *)dst + len;
-		while (d != end)
+		const uint8_t *s = (const uint8_t *)src + len;
+		uint8_t *d = (uint8_t *)dst + len;
+
+		/*
+		 * Copy 64-bit words if both ends can be aligned together. The
+		 * destination is above the source, so a word read always
+		 * happens before the overlapping word is written.
+		 */
+		if ((((uintptr_t)d ^ (uintptr_t)s) & 7U) == 0U) {
+			const uint64_t *s64;
+			uint64_t *d64;
+
+			while ((len > 0U) && (((uintptr_t)d & 7U) != 0U)) {
+				*--d = *--s;
+				len--;
+			}
+
+			s64 = (const uint64_t *)s;
+			d64 = (uint64_t *)d;
+			for (; len >= 8U; len -= 8U) {
+				*--d64 = *--s64;
+			}
+
+			s = (const uint8_t *)s64;
+			d = (uint8_t *)d64;
+		}
+
+		while (len-- > 0U) {
 			*--d = *--s;
+		}
 	}
 	return dst;
 }
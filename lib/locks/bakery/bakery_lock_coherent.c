@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -40,8 +40,9 @@
 	assert((_entry) < BAKERY_LOCK_MAX_CPUS);	\
 } while (false)
 
-/* Obtain a ticket for a given CPU */
-static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
+/* Obtain a ticket for a given CPU among the contenders in [first, end) */
+static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me,
+				      unsigned int first, unsigned int end)
 {
 	unsigned int my_ticket, their_ticket;
 	unsigned int they;
@@ -61,7 +62,7 @@ static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
 	 */
 	my_ticket = 0U;
 	bakery->lock_data[me] = make_bakery_data(CHOOSING_TICKET, my_ticket);
-	for (they = 0U; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first; they < end; they++) {
 		their_ticket = bakery_ticket_number(bakery->lock_data[they]);
 		if (their_ticket > my_ticket)
 			my_ticket = their_ticket;
@@ -88,26 +89,32 @@ static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
  * (and priority) value as 0. The contending CPU compares its priority with that
  * of others'. The CPU with the highest priority (lowest numerical value)
  * acquires the lock
+ *
+ * Only the CPUs in the range [first, first + count) are considered. The caller
+ * guarantees that no CPU outside of this range ever contends for the lock.
  */
-void bakery_lock_get(bakery_lock_t *bakery)
+void bakery_lock_get_range(bakery_lock_t *bakery, unsigned int first,
+			   unsigned int count)
 {
-	unsigned int they, me;
+	unsigned int they, me, end;
 	unsigned int my_ticket, my_prio, their_ticket;
 	unsigned int their_bakery_data;
 
 	me = plat_my_core_pos();
+	end = first + count;
 
 	assert_bakery_entry_valid(me, bakery);
+	assert((me >= first) && (me < end) && (end <= BAKERY_LOCK_MAX_CPUS));
 
 	/* Get a ticket */
-	my_ticket = bakery_get_ticket(bakery, me);
+	my_ticket = bakery_get_ticket(bakery, me, first, end);
 
 	/*
 	 * Now that we got our ticket, compute our priority value, then compare
 	 * with that of others, and proceed to acquire the lock
 	 */
 	my_prio = bakery_get_priority(my_ticket, me);
-	for (they = 0U; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first; they < end; they++) {
 		if (me == they)
 			continue;
 
@@ -144,6 +151,11 @@ void bakery_lock_get(bakery_lock_t *bakery)
 	dmbish();
 }
 
+void bakery_lock_get(bakery_lock_t *bakery)
+{
+	bakery_lock_get_range(bakery, 0U, BAKERY_LOCK_MAX_CPUS);
+}
+
 
 /* Release the lock and signal contenders */
 void bakery_lock_release(bakery_lock_t *bakery)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  * Copyright (c) 2020, NVIDIA Corporation. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
@@ -99,7 +99,8 @@ static inline bool is_lock_acquired(const bakery_info_t *my_bakery_info,
 }
 
 static unsigned int bakery_get_ticket(bakery_lock_t *lock,
-				      unsigned int me, bool is_cached)
+				      unsigned int me, unsigned int first,
+				      unsigned int end, bool is_cached)
 {
 	unsigned int my_ticket, their_ticket;
 	unsigned int they;
@@ -128,7 +129,7 @@ static unsigned int bakery_get_ticket(bakery_lock_t *lock,
 	 * Iterate through the bakery information of each contender to allocate
 	 * the highest ticket number for this cpu.
 	 */
-	for (they = 0U; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first; they < end; they++) {
 		if (me == they)
 			continue;
 
@@ -162,26 +163,35 @@ static unsigned int bakery_get_ticket(bakery_lock_t *lock,
 	return my_ticket;
 }
 
-void bakery_lock_get(bakery_lock_t *lock)
+/*
+ * Acquire the lock, only considering the CPUs in the range
+ * [first, first + count) as contenders. The caller guarantees that no CPU
+ * outside of this range ever contends for the lock.
+ */
+void bakery_lock_get_range(bakery_lock_t *lock, unsigned int first,
+			   unsigned int count)
 {
-	unsigned int they, me;
+	unsigned int they, me, end;
 	unsigned int my_ticket, my_prio, their_ticket;
 	bakery_info_t *their_bakery_info;
 	unsigned int their_bakery_data;
 	bool is_cached;
 
 	me = plat_my_core_pos();
+	end = first + count;
 	is_cached = is_dcache_enabled();
 
+	assert((me >= first) && (me < end) && (end <= BAKERY_LOCK_MAX_CPUS));
+
 	/* Get a ticket */
-	my_ticket = bakery_get_ticket(lock, me, is_cached);
+	my_ticket = bakery_get_ticket(lock, me, first, end, is_cached);
 
 	/*
 	 * Now that we got our ticket, compute our priority value, then compare
 	 * with that of others, and proceed to acquire the lock
 	 */
 	my_prio = bakery_get_priority(my_ticket, me);
-	for (they = 0U; they < BAKERY_LOCK_MAX_CPUS; they++) {
+	for (they = first; they < end; they++) {
 		if (me == they)
 			continue;
 
@@ -226,6 +236,11 @@ void bakery_lock_get(bakery_lock_t *lock)
 	dmbish();
 }
 
+void bakery_lock_get(bakery_lock_t *lock)
+{
+	bakery_lock_get_range(lock, 0U, BAKERY_LOCK_MAX_CPUS);
+}
+
 void bakery_lock_release(bakery_lock_t *lock)
 {
 	bakery_info_t *my_bakery_info;
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <lib/smccc.h>
+#include <lib/spinlock.h>
+#include <smccc_helpers.h>
+
+/*
+ * Locks are registered the first time they are acquired, so that their
+ * statistics can be found without knowing where they are defined.
+ */
+static const spinlock_t *spinlock_stats_locks[SPINLOCK_STATS_MAX_LOCKS];
+static unsigned int spinlock_stats_count;
+static spinlock_t spinlock_stats_lock;
+
+static void spinlock_stats_register(spinlock_t *lock)
+{
+	/* The registry lock itself is not registered */
+	(void)spin_lock_ticket(&spinlock_stats_lock);
+
+	if (spinlock_stats_count < SPINLOCK_STATS_MAX_LOCKS) {
+		spinlock_stats_locks[spinlock_stats_count] = lock;
+		spinlock_stats_count++;
+	} else {
+		VERBOSE("Spinlock %p not tracked, registry full\n",
+			(void *)lock);
+	}
+
+	spin_unlock(&spinlock_stats_lock);
+
+	lock->registered = 1U;
+}
+
+/*
+ * Acquire the lock and update its statistics. The statistics are updated with
+ * the lock held, so no further synchronisation is needed.
+ */
+void spin_lock_stats(spinlock_t *lock)
+{
+	uint64_t start = read_cntpct_el0();
+	uint64_t wait;
+	unsigned int spins;
+
+	spins = spin_lock_ticket(lock);
+
+	lock->acquisitions++;
+	if (spins != 0U) {
+		wait = read_cntpct_el0() - start;
+		lock->contended++;
+		lock->spins += spins;
+		if (wait > lock->max_wait) {
+			lock->max_wait = wait;
+		}
+	}
+
+	if (lock->registered == 0U) {
+		spinlock_stats_register(lock);
+	}
+}
+
+/*
+ * Return the registered lock at index 'idx'. The statistics it holds are read
+ * without taking the lock, so they may be slightly out of date.
+ */
+int spinlock_stats_get(unsigned int idx, const spinlock_t **lock)
+{
+	int rc = -1;
+
+	(void)spin_lock_ticket(&spinlock_stats_lock);
+	if (idx < spinlock_stats_count) {
+		*lock = spinlock_stats_locks[idx];
+		rc = 0;
+	}
+	spin_unlock(&spinlock_stats_lock);
+
+	return rc;
+}
+
+/*
+ * Return the statistics of the lock registered at index x1:
+ *   x0 --> SMC_OK, or SMC_UNK if there is no such lock.
+ *   x1 --> address of the lock.
+ *   x2 --> number of acquisitions.
+ *   x3 --> number of contended acquisitions.
+ *   x4 --> number of wait loop iterations.
+ *   x5 --> longest wait, in generic timer ticks.
+ */
+uintptr_t spinlock_stats_smc_handler(unsigned int smc_fid,
+				     u_register_t x1,
+				     u_register_t x2,
+				     u_register_t x3,
+				     u_register_t x4,
+				     void *cookie,
+				     void *handle,
+				     u_register_t flags)
+{
+	const spinlock_t *lock;
+
+	/* Allow calls from non-secure only */
+	if (is_caller_secure(flags)) {
+		SMC_RET1(handle, SMC_UNK);
+	}
+
+	if ((smc_fid != SPINLOCK_STATS_SMC_64) ||
+	    (x1 > UINT32_MAX) ||
+	    (spinlock_stats_get((unsigned int)x1, &lock) != 0)) {
+		SMC_RET1(handle, SMC_UNK);
+	}
+
+	SMC_RET6(handle, SMC_OK, (uintptr_t)lock, lock->acquisitions,
+		 lock->contended, lock->spins, lock->max_wait);
+}
@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <lib/utils_def.h>
+#include <tf_unlz4.h>
+
+/*
+ * Decoder for the LZ4 frame format, as produced by the lz4 command line tool.
+ * The whole output is kept in a single buffer, so the blocks of a frame can
+ * refer to each other without a separate history buffer and no workspace is
+ * needed. Frames using a dictionary are not supported.
+ */
+
+#define LZ4_FRAME_MAGIC		U(0x184D2204)
+#define LZ4_SKIPPABLE_MAGIC	U(0x184D2A50)
+#define LZ4_SKIPPABLE_MASK	U(0xFFFFFFF0)
+
+/* Frame descriptor */
+#define LZ4_FLG_VERSION_SHIFT	6
+#define LZ4_FLG_VERSION_MASK	U(0x3)
+#define LZ4_FLG_VERSION		U(0x1)
+#define LZ4_FLG_BLOCK_CHECKSUM	BIT_32(4)
+#define LZ4_FLG_CONTENT_SIZE	BIT_32(3)
+#define LZ4_FLG_CONTENT_CHECKSUM BIT_32(2)
+#define LZ4_FLG_RESERVED	BIT_32(1)
+#define LZ4_FLG_DICT_ID		BIT_32(0)
+#define LZ4_BD_RESERVED		U(0x8F)
+
+/* Block header */
+#define LZ4_BLOCK_UNCOMPRESSED	BIT_32(31)
+#define LZ4_BLOCK_SIZE_MASK	U(0x7FFFFFFF)
+
+/* Sequences */
+#define LZ4_MIN_MATCH		4U
+#define LZ4_RUN_MASK		15U
+
+/* xxHash32, used by the frame checksums */
+#define XXH_PRIME32_1		U(0x9E3779B1)
+#define XXH_PRIME32_2		U(0x85EBCA77)
+#define XXH_PRIME32_3		U(0xC2B2AE3D)
+#define XXH_PRIME32_4		U(0x27D4EB2F)
+#define XXH_PRIME32_5		U(0x165667B1)
+
+/* Input being parsed: the current position and the end of the data */
+struct lz4_in {
+	const uint8_t *pos;
+	const uint8_t *end;
+};
+
+static inline uint32_t get_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+	       ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t rotl32(uint32_t x, unsigned int r)
+{
+	return (x << r) | (x >> (32U - r));
+}
+
+static inline uint32_t xxh32_round(uint32_t acc, uint32_t input)
+{
+	acc += input * XXH_PRIME32_2;
+	return rotl32(acc, 13U) * XXH_PRIME32_1;
+}
+
+static uint32_t xxh32(const uint8_t *p, size_t len)
+{
+	const uint8_t *end = p + len;
+	uint32_t v1, v2, v3, v4, h;
+
+	if (len >= 16U) {
+		v1 = XXH_PRIME32_1 + XXH_PRIME32_2;
+		v2 = XXH_PRIME32_2;
+		v3 = 0U;
+		v4 = 0U - XXH_PRIME32_1;
+
+		do {
+			v1 = xxh32_round(v1, get_le32(p));
+			v2 = xxh32_round(v2, get_le32(p + 4));
+			v3 = xxh32_round(v3, get_le32(p + 8));
+			v4 = xxh32_round(v4, get_le32(p + 12));
+			p += 16;
+		} while ((size_t)(end - p) >= 16U);
+
+		h = rotl32(v1, 1U) + rotl32(v2, 7U) + rotl32(v3, 12U) +
+		    rotl32(v4, 18U);
+	} else {
+		h = XXH_PRIME32_5;
+	}
+
+	h += (uint32_t)len;
+
+	while ((size_t)(end - p) >= 4U) {
+		h += get_le32(p) * XXH_PRIME32_3;
+		h = rotl32(h, 17U) * XXH_PRIME32_4;
+		p += 4;
+	}
+
+	while (p < end) {
+		h += (uint32_t)*p * XXH_PRIME32_5;
+		h = rotl32(h, 11U) * XXH_PRIME32_1;
+		p++;
+	}
+
+	h ^= h >> 15;
+	h *= XXH_PRIME32_2;
+	h ^= h >> 13;
+	h *= XXH_PRIME32_3;
+	h ^= h >> 16;
+
+	return h;
+}
+
+static int lz4_get(struct lz4_in *in, const uint8_t **data, size_t len)
+{
+	if ((size_t)(in->end - in->pos) < len) {
+		ERROR("lz4: truncated input\n");
+		return -EIO;
+	}
+
+	*data = in->pos;
+	in->pos += len;
+
+	return 0;
+}
+
+/* Read the extension of a literal or match length */
+static int lz4_get_length(const uint8_t **ip, const uint8_t *iend,
+			  size_t *len)
+{
+	uint8_t b;
+
+	do {
+		if (*ip >= iend) {
+			return -EIO;
+		}
+		b = *(*ip)++;
+		*len += b;
+	} while (b == 255U);
+
+	return 0;
+}
+
+/*
+ * Decode the block of 'in_len' bytes at 'ip' to 'op'. Matches may refer to
+ * any earlier output of the frame, from 'ostart' on.
+ */
+static int lz4_decode_block(const uint8_t *ip, size_t in_len, uint8_t *ostart,
+			    uint8_t **op_ptr, uint8_t *oend)
+{
+	const uint8_t *iend = ip + in_len;
+	const uint8_t *match;
+	uint8_t *op = *op_ptr;
+	size_t len, offset;
+	uint8_t token;
+
+	while (ip < iend) {
+		token = *ip++;
+
+		/* Literals */
+		len = token >> 4;
+		if ((len == LZ4_RUN_MASK) &&
+		    (lz4_get_length(&ip, iend, &len) != 0)) {
+			return -EIO;
+		}
+		if (((size_t)(iend - ip) < len) ||
+		    ((size_t)(oend - op) < len)) {
+			return -EIO;
+		}
+		(void)memcpy(op, ip, len);
+		op += len;
+		ip += len;
+
+		/* The last sequence of a block only has literals */
+		if (ip == iend) {
+			break;
+		}
+
+		/* Match */
+		if ((size_t)(iend - ip) < 2U) {
+			return -EIO;
+		}
+		offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+		if ((offset == 0U) || (offset > (size_t)(op - ostart))) {
+			return -EIO;
+		}
+
+		len = token & LZ4_RUN_MASK;
+		if ((len == LZ4_RUN_MASK) &&
+		    (lz4_get_length(&ip, iend, &len) != 0)) {
+			return -EIO;
+		}
+		len += LZ4_MIN_MATCH;
+		if ((size_t)(oend - op) < len) {
+			return -EIO;
+		}
+
+		match = op - offset;
+		if (offset >= len) {
+			(void)memcpy(op, match, len);
+			op += len;
+		} else {
+			/* Overlapping match, repeating the last bytes */
+			while (len-- != 0U) {
+				*op++ = *match++;
+			}
+		}
+	}
+
+	*op_ptr = op;
+
+	return 0;
+}
+
+static int lz4_decode_frame(struct lz4_in *in, uint8_t *ostart,
+			    uint8_t **op_ptr, uint8_t *oend)
+{
+	const uint8_t *desc, *data;
+	uint8_t *op = *op_ptr;
+	uint8_t *frame_start = op;
+	uint64_t content_size = 0U;
+	uint32_t flg, size;
+	size_t desc_len;
+	int ret;
+
+	/* Frame descriptor, up to the header checksum */
+	ret = lz4_get(in, &desc, 2U);
+	if (ret != 0) {
+		return ret;
+	}
+
+	flg = desc[0];
+	if ((((flg >> LZ4_FLG_VERSION_SHIFT) & LZ4_FLG_VERSION_MASK) !=
+	     LZ4_FLG_VERSION) || ((flg & LZ4_FLG_RESERVED) != 0U) ||
+	    ((desc[1] & LZ4_BD_RESERVED) != 0U)) {
+		ERROR("lz4: unsupported frame descriptor\n");
+		return -EIO;
+	}
+
+	if ((flg & LZ4_FLG_DICT_ID) != 0U) {
+		ERROR("lz4: dictionaries are not supported\n");
+		return -EIO;
+	}
+
+	desc_len = 2U;
+	if ((flg & LZ4_FLG_CONTENT_SIZE) != 0U) {
+		ret = lz4_get(in, &data, 8U);
+		if (ret != 0) {
+			return ret;
+		}
+		content_size = get_le32(data) |
+			       ((uint64_t)get_le32(data + 4) << 32);
+		desc_len += 8U;
+	}
+
+	ret = lz4_get(in, &data, 1U);
+	if (ret != 0) {
+		return ret;
+	}
+	if (*data != (uint8_t)(xxh32(desc, desc_len) >> 8)) {
+		ERROR("lz4: bad header checksum\n");
+		return -EIO;
+	}
+
+	if (content_size > (uint64_t)(oend - op)) {
+		ERROR("lz4: output buffer too small\n");
+		return -ENOMEM;
+	}
+
+	/* Blocks, up to the end mark */
+	for (;;) {
+		ret = lz4_get(in, &data, 4U);
+		if (ret != 0) {
+			return ret;
+		}
+
+		size = get_le32(data);
+		if (size == 0U) {
+			break;
+		}
+
+		ret = lz4_get(in, &data, size & LZ4_BLOCK_SIZE_MASK);
+		if (ret != 0) {
+			return ret;
+		}
+
+		if ((flg & LZ4_FLG_BLOCK_CHECKSUM) != 0U) {
+			const uint8_t *sum;
+
+			ret = lz4_get(in, &sum, 4U);
+			if (ret != 0) {
+				return ret;
+			}
+			if (get_le32(sum) !=
+			    xxh32(data, size & LZ4_BLOCK_SIZE_MASK)) {
+				ERROR("lz4: bad block checksum\n");
+				return -EIO;
+			}
+		}
+
+		if ((size & LZ4_BLOCK_UNCOMPRESSED) != 0U) {
+			size &= LZ4_BLOCK_SIZE_MASK;
+			if ((size_t)(oend - op) < size) {
+				ERROR("lz4: output buffer too small\n");
+				return -ENOMEM;
+			}
+			(void)memcpy(op, data, size);
+			op += size;
+		} else {
+			ret = lz4_decode_block(data, size, ostart, &op, oend);
+			if (ret != 0) {
+				ERROR("lz4: corrupted block\n");
+				return ret;
+			}
+		}
+	}
+
+	if (((flg & LZ4_FLG_CONTENT_SIZE) != 0U) &&
+	    (content_size != (uint64_t)(op - frame_start))) {
+		ERROR("lz4: bad content size\n");
+		return -EIO;
+	}
+
+	if ((flg & LZ4_FLG_CONTENT_CHECKSUM) != 0U) {
+		ret = lz4_get(in, &data, 4U);
+		if (ret != 0) {
+			return ret;
+		}
+		if (get_le32(data) !=
+		    xxh32(frame_start, (size_t)(op - frame_start))) {
+			ERROR("lz4: bad content checksum\n");
+			return -EIO;
+		}
+	}
+
+	*op_ptr = op;
+
+	return 0;
+}
+
+/*
+ * unlz4 - decompress LZ4 frames
+ * @in_buf: source of compressed input. Upon exit, the end of input.
+ * @in_len: length of in_buf
+ * @out_buf: destination of decompressed output. Upon exit, the end of output.
+ * @out_len: length of out_buf
+ * @work_buf: workspace, unused
+ * @work_len: length of workspace
+ *
+ * Consecutive frames are decompressed one after the other and skippable
+ * frames are ignored. The decoding stops at the end of the input or at the
+ * first data that is not a frame, such as padding.
+ */
+int unlz4(uintptr_t *in_buf, size_t in_len, uintptr_t *out_buf,
+	  size_t out_len, uintptr_t work_buf, size_t work_len)
+{
+	struct lz4_in in;
+	uint8_t *ostart = (uint8_t *)*out_buf;
+	uint8_t *op = ostart;
+	const uint8_t *data;
+	uint32_t magic;
+	bool found = false;
+	int ret = 0;
+
+	in.pos = (const uint8_t *)*in_buf;
+	in.end = in.pos + in_len;
+
+	while ((size_t)(in.end - in.pos) >= 4U) {
+		magic = get_le32(in.pos);
+
+		if ((magic & LZ4_SKIPPABLE_MASK) == LZ4_SKIPPABLE_MAGIC) {
+			in.pos += 4;
+			ret = lz4_get(&in, &data, 4U);
+			if (ret == 0) {
+				ret = lz4_get(&in, &data, get_le32(data));
+			}
+		} else if (magic == LZ4_FRAME_MAGIC) {
+			in.pos += 4;
+			ret = lz4_decode_frame(&in, ostart, &op,
+					       ostart + out_len);
+			found = true;
+		} else {
+			break;
+		}
+
+		if (ret != 0) {
+			break;
+		}
+	}
+
+	if ((ret == 0) && !found) {
+		ERROR("lz4: no frame found\n");
+		ret = -EIO;
+	}
+
+	VERBOSE("lz4: %lu byte input\n",
+		(unsigned long)((uintptr_t)in.pos - *in_buf));
+	VERBOSE("lz4: %lu byte output\n", (unsigned long)(op - ostart));
+
+	*in_buf = (uintptr_t)in.pos;
+	*out_buf = (uintptr_t)op;
+
+	return ret;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+
+#include <common/debug.h>
+#include <lib/pmf/pmf.h>
+#include <lib/spinlock.h>
+#include <lib/utils_def.h>
+#include <lib/xlat_tables/xlat_tables_v2.h>
+#include <plat/common/platform.h>
+
+#if !PLAT_XLAT_TABLES_DYNAMIC
+#error "The PMF calls that copy data to the normal world need PLAT_XLAT_TABLES_DYNAMIC"
+#endif
+
+/* Serialises the copies to the normal world and the mappings they need */
+static spinlock_t pmf_ns_buf_lock;
+
+/*
+ * Map the normal world buffer of 'buf_size' bytes at physical address
+ * 'buf_pa' as non-secure memory and let 'fill' write 'size' bytes of data to
+ * it. The mapping is removed before returning, so the buffer does not need to
+ * be known in advance, but the platform must confirm that the pages holding
+ * it are normal world memory. Returns 0 on success, -ENOMEM if the buffer is
+ * too small for the data and -EINVAL if its address is not valid.
+ */
+int pmf_copy_to_ns_buf(u_register_t buf_pa, u_register_t buf_size,
+		       size_t size, void (*fill)(void *dst))
+{
+	unsigned long long base_pa;
+	uintptr_t base_va;
+	size_t map_size;
+	int rc;
+
+	assert(fill != NULL);
+
+	if (buf_size < size) {
+		return -ENOMEM;
+	}
+
+	if ((buf_pa == 0U) || ((buf_pa & (sizeof(uint64_t) - 1U)) != 0U) ||
+	    (buf_pa > (UINTPTR_MAX - size))) {
+		return -EINVAL;
+	}
+
+	base_pa = round_down(buf_pa, PAGE_SIZE);
+	map_size = round_up(buf_pa + size, PAGE_SIZE) - base_pa;
+
+	/* Never let the normal world make EL3 write to secure memory */
+	if (!plat_is_ns_buffer(base_pa, map_size)) {
+		VERBOSE("PMF: buffer at 0x%lx is not in normal world memory\n",
+			buf_pa);
+		return -EINVAL;
+	}
+
+	spin_lock(&pmf_ns_buf_lock);
+
+	rc = mmap_add_dynamic_region_alloc_va(base_pa, &base_va, map_size,
+					      MT_MEMORY | MT_RW | MT_NS |
+					      MT_EXECUTE_NEVER);
+	if (rc != 0) {
+		VERBOSE("PMF: failed to map buffer at 0x%lx (%d)\n",
+			buf_pa, rc);
+		spin_unlock(&pmf_ns_buf_lock);
+		return rc;
+	}
+
+	fill((void *)(base_va + (buf_pa - base_pa)));
+
+	rc = mmap_remove_dynamic_region(base_va, map_size);
+	assert(rc == 0);
+
+	spin_unlock(&pmf_ns_buf_lock);
+
+	return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <arch_helpers.h>
+#include <lib/cassert.h>
+#include <lib/pmf/pmf.h>
+#include <lib/pmf/pmf_rt_svc_hist.h>
+#include <plat/common/platform.h>
+
+#include <platform_def.h>
+
+/*
+ * The histograms are only updated by the CPU that owns them, so no lock is
+ * needed to record a call. Each CPU's table is aligned to a cache line so
+ * that the CPUs do not contend for the same lines.
+ */
+typedef struct rt_svc_hist_cpu {
+	rt_svc_hist_entry_t entries[RT_SVC_HIST_ENTRIES];
+} __aligned(CACHE_WRITEBACK_GRANULE) rt_svc_hist_cpu_t;
+
+static rt_svc_hist_cpu_t rt_svc_hist[PLATFORM_CORE_COUNT];
+
+CASSERT((sizeof(rt_svc_hist_hdr_t) % sizeof(uint64_t)) == 0U,
+	assert_rt_svc_hist_hdr_size_mismatch);
+CASSERT((sizeof(rt_svc_hist_entry_t) % sizeof(uint64_t)) == 0U,
+	assert_rt_svc_hist_entry_size_mismatch);
+CASSERT(RT_SVC_HIST_FIDS_SHIFT < 32, assert_rt_svc_hist_fids_shift_too_big);
+
+/* Fibonacci hashing of the function ID to a slot of the table */
+static inline unsigned int rt_svc_hist_slot(uint32_t smc_fid)
+{
+	return (unsigned int)((smc_fid * U(0x9E3779B1)) >>
+			      (32U - RT_SVC_HIST_FIDS_SHIFT));
+}
+
+static inline unsigned int rt_svc_hist_bucket(uint64_t ticks)
+{
+	unsigned int bucket;
+
+	if (ticks == 0U) {
+		return 0U;
+	}
+
+	bucket = 64U - (unsigned int)__builtin_clzll(ticks);
+
+	return (bucket < RT_SVC_HIST_BUCKETS) ? bucket :
+						(RT_SVC_HIST_BUCKETS - 1U);
+}
+
+/*
+ * Find the histogram of 'smc_fid' on this CPU, claiming a free slot the first
+ * time the function ID is seen. When the table is full, the calls are
+ * accounted in the last histogram instead.
+ */
+static rt_svc_hist_entry_t *rt_svc_hist_find(rt_svc_hist_entry_t *entries,
+					     uint32_t smc_fid)
+{
+	rt_svc_hist_entry_t *entry;
+	unsigned int slot = rt_svc_hist_slot(smc_fid);
+	unsigned int i;
+
+	for (i = 0U; i < RT_SVC_HIST_MAX_FIDS; i++) {
+		entry = &entries[slot];
+		if (entry->valid == 0U) {
+			break;
+		}
+		if (entry->fid == smc_fid) {
+			return entry;
+		}
+		slot = (slot + 1U) & (RT_SVC_HIST_MAX_FIDS - 1U);
+	}
+
+	if (i == RT_SVC_HIST_MAX_FIDS) {
+		entry = &entries[RT_SVC_HIST_MAX_FIDS];
+		smc_fid = RT_SVC_HIST_FID_OTHER;
+		if (entry->valid != 0U) {
+			return entry;
+		}
+	}
+
+	entry->fid = smc_fid;
+	entry->min = UINT64_MAX;
+	entry->valid = 1U;
+
+	return entry;
+}
+
+/*
+ * Account the latency of a runtime service call that started at generic timer
+ * count 'start' and has just returned.
+ */
+void pmf_rt_svc_hist_record(uint32_t smc_fid, uint64_t start)
+{
+	uint64_t ticks = read_cntpct_el0() - start;
+	rt_svc_hist_entry_t *entry;
+
+	entry = rt_svc_hist_find(rt_svc_hist[plat_my_core_pos()].entries,
+				 smc_fid);
+
+	entry->count++;
+	entry->buckets[rt_svc_hist_bucket(ticks)]++;
+	if (ticks < entry->min) {
+		entry->min = ticks;
+	}
+	if (ticks > entry->max) {
+		entry->max = ticks;
+	}
+}
+
+/* Write the header and the histograms of all the CPUs to 'dst' */
+static void rt_svc_hist_fill(void *dst)
+{
+	rt_svc_hist_hdr_t *hdr = dst;
+	rt_svc_hist_entry_t *entries = (rt_svc_hist_entry_t *)(hdr + 1);
+	unsigned int cpu;
+
+	hdr->version = RT_SVC_HIST_VERSION;
+	hdr->num_cpus = PLATFORM_CORE_COUNT;
+	hdr->num_entries = RT_SVC_HIST_ENTRIES;
+	hdr->num_buckets = RT_SVC_HIST_BUCKETS;
+	hdr->cntfrq = read_cntfrq_el0();
+
+	for (cpu = 0U; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		(void)memcpy(entries, rt_svc_hist[cpu].entries,
+			     sizeof(rt_svc_hist[cpu].entries));
+		entries += RT_SVC_HIST_ENTRIES;
+	}
+}
+
+/*
+ * Copy the histograms of all the CPUs to the normal world buffer of
+ * 'buf_size' bytes at physical address 'buf_pa'. The size of the whole block
+ * is returned in 'size' so that a caller can query it with an empty buffer.
+ * The histograms of the other CPUs are read while they may be updated, so a
+ * few of their calls may be missing from the copy.
+ */
+int pmf_rt_svc_hist_get_smc(u_register_t buf_pa, u_register_t buf_size,
+			    u_register_t *size)
+{
+	*size = sizeof(rt_svc_hist_hdr_t) + (PLATFORM_CORE_COUNT *
+					     sizeof(rt_svc_hist[0].entries));
+
+	return pmf_copy_to_ns_buf(buf_pa, buf_size, *size, rt_svc_hist_fill);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,6 +8,8 @@
 
 #include <common/debug.h>
 #include <lib/pmf/pmf.h>
+#include <lib/pmf/pmf_rt_svc_hist.h>
+#include <lib/psci/psci_lib.h>
 #include <plat/common/platform.h>
 #include <smccc_helpers.h>
 
@@ -25,6 +27,9 @@ uintptr_t pmf_smc_handler(unsigned int smc_fid,
 {
 	int rc;
 	unsigned long long ts_value;
+#if ENABLE_RT_SVC_HISTOGRAMS || PSCI_STAT_SNAPSHOT
+	u_register_t size;
+#endif
 
 	if (((smc_fid >> FUNCID_CC_SHIFT) & FUNCID_CC_MASK) == SMC_32) {
 
@@ -44,6 +49,32 @@ uintptr_t pmf_smc_handler(unsigned int smc_fid,
 			SMC_RET3(handle, rc, (uint32_t)ts_value,
 					(uint32_t)(ts_value >> 32));
 		}
+#if ENABLE_RT_SVC_HISTOGRAMS
+		if (smc_fid == PMF_SMC_GET_RT_SVC_HIST_32) {
+			/*
+			 * Copy the runtime service latency histograms
+			 * to the buffer at x1 of x2 bytes.
+			 * x0 --> error code.
+			 * x1 --> size of the histogram block.
+			 */
+			rc = pmf_rt_svc_hist_get_smc(x1, x2, &size);
+			SMC_RET2(handle, rc, size);
+		}
+#endif
+#if PSCI_STAT_SNAPSHOT
+		if (smc_fid == PMF_SMC_GET_PSCI_STAT_32) {
+			/*
+			 * Copy the PSCI statistics of all the power
+			 * domains to the buffer at x1 of x2 bytes.
+			 * x0 --> error code.
+			 * x1 --> size of the statistics block.
+			 */
+			size = psci_stat_snapshot_size();
+			rc = pmf_copy_to_ns_buf(x1, x2, size,
+					psci_stat_snapshot);
+			SMC_RET2(handle, rc, size);
+		}
+#endif
 	} else {
 		if (smc_fid == PMF_SMC_GET_TIMESTAMP_64) {
 			/*
@@ -56,6 +87,32 @@ uintptr_t pmf_smc_handler(unsigned int smc_fid,
 					(unsigned int)x3, &ts_value);
 			SMC_RET2(handle, rc, ts_value);
 		}
+#if ENABLE_RT_SVC_HISTOGRAMS
+		if (smc_fid == PMF_SMC_GET_RT_SVC_HIST_64) {
+			/*
+			 * Copy the runtime service latency histograms
+			 * to the buffer at x1 of x2 bytes.
+			 * x0 --> error code.
+			 * x1 --> size of the histogram block.
+			 */
+			rc = pmf_rt_svc_hist_get_smc(x1, x2, &size);
+			SMC_RET2(handle, rc, size);
+		}
+#endif
+#if PSCI_STAT_SNAPSHOT
+		if (smc_fid == PMF_SMC_GET_PSCI_STAT_64) {
+			/*
+			 * Copy the PSCI statistics of all the power
+			 * domains to the buffer at x1 of x2 bytes.
+			 * x0 --> error code.
+			 * x1 --> size of the statistics block.
+			 */
+			size = psci_stat_snapshot_size();
+			rc = pmf_copy_to_ns_buf(x1, x2, size,
+					psci_stat_snapshot);
+			SMC_RET2(handle, rc, size);
+		}
+#endif
 	}
 
 	WARN("Unimplemented PMF Call: 0x%x \n", smc_fid);
@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include <arch.h>
@@ -14,6 +15,8 @@
 #include <context.h>
 #include <drivers/delay_timer.h>
 #include <lib/el3_runtime/context_mgmt.h>
+#include <lib/pmf/pmf.h>
+#include <lib/runtime_instr.h>
 #include <lib/utils.h>
 #include <plat/common/platform.h>
 
@@ -62,6 +65,11 @@ __section("tzfw_coherent_mem")
 /* Lock for PSCI state coordination */
 DEFINE_PSCI_LOCK(psci_locks[PSCI_NUM_NON_CPU_PWR_DOMAINS]);
 
+#if HW_ASSISTED_COHERENCY && PSCI_QUEUED_LOCKS
+/* Per-CPU queue nodes for the PSCI locks */
+psci_lock_nodes_t psci_lock_nodes[PLATFORM_CORE_COUNT];
+#endif
+
 cpu_pd_node_t psci_cpu_pd_nodes[PLATFORM_CORE_COUNT];
 
 /*******************************************************************************
@@ -390,8 +398,18 @@ void psci_set_pwr_domains_to_run(unsigned int end_pwrlvl)
 		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 	}
 
-	/* Set the affinity info state to ON */
+	/*
+	 * Set the affinity info state to ON. With PARALLEL_CPU_ON, a CPU that
+	 * is being turned on is only reported ON by psci_cpu_on_finish_local(),
+	 * once its context is complete.
+	 */
+#if PARALLEL_CPU_ON
+	if (psci_get_aff_info_state() != AFF_STATE_ON_PENDING) {
+		psci_set_aff_info_state(AFF_STATE_ON);
+	}
+#else
 	psci_set_aff_info_state(AFF_STATE_ON);
+#endif
 
 	psci_set_cpu_local_state(PSCI_LOCAL_STATE_RUN);
 	psci_flush_cpu_data(psci_svc_cpu_data);
@@ -583,11 +601,23 @@ void psci_acquire_pwr_domain_locks(unsigned int end_pwrlvl,
 	unsigned int parent_idx;
 	unsigned int level;
 
+#if ENABLE_RUNTIME_INSTRUMENTATION
+	PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
+	    RT_INSTR_ENTER_PSCI_LOCKS,
+	    PMF_NO_CACHE_MAINT);
+#endif
+
 	/* No locking required for level 0. Hence start locking from level 1 */
 	for (level = PSCI_CPU_PWR_LVL + 1U; level <= end_pwrlvl; level++) {
 		parent_idx = parent_nodes[level - 1U];
 		psci_lock_get(&psci_non_cpu_pd_nodes[parent_idx]);
 	}
+
+#if ENABLE_RUNTIME_INSTRUMENTATION
+	PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
+	    RT_INSTR_EXIT_PSCI_LOCKS,
+	    PMF_NO_CACHE_MAINT);
+#endif
 }
 
 /*******************************************************************************
@@ -772,6 +802,7 @@ void psci_warmboot_entrypoint(void)
 	unsigned int cpu_idx = plat_my_core_pos();
 	unsigned int parent_nodes[PLAT_MAX_PWR_LVL] = {0};
 	psci_power_state_t state_info = { {PSCI_LOCAL_STATE_RUN} };
+	bool cpu_on;
 
 	/*
 	 * Verify that we have been explicitly turned ON or resumed from
@@ -782,6 +813,11 @@ void psci_warmboot_entrypoint(void)
 		panic();
 	}
 
+#if CTX_LAZY_SYSREGS
+	/* The lower EL system registers lost their values at power down */
+	cm_sysregs_reset_owners();
+#endif
+
 	/*
 	 * Get the maximum power domain level to traverse to after this cpu
 	 * has been physically powered up.
@@ -816,7 +852,8 @@ void psci_warmboot_entrypoint(void)
 	 * of power management handler and perform the generic, architecture
 	 * and platform specific handling.
 	 */
-	if (psci_get_aff_info_state() == AFF_STATE_ON_PENDING)
+	cpu_on = (psci_get_aff_info_state() == AFF_STATE_ON_PENDING);
+	if (cpu_on)
 		psci_cpu_on_finish(cpu_idx, &state_info);
 	else
 		psci_cpu_suspend_finish(cpu_idx, &state_info);
@@ -842,6 +879,16 @@ void psci_warmboot_entrypoint(void)
 	 * in the reverse order to which they were acquired.
 	 */
 	psci_release_pwr_domain_locks(end_pwrlvl, parent_nodes);
+
+#if PARALLEL_CPU_ON
+	/*
+	 * The rest of a CPU_ON request only concerns this CPU, so finish it
+	 * without holding the locks of the power domains it shares with the
+	 * other CPUs.
+	 */
+	if (cpu_on)
+		psci_cpu_on_finish_local(cpu_idx);
+#endif
 }
 
 /*******************************************************************************
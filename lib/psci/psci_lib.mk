@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+# Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -24,6 +24,14 @@ ifeq (${ARCH}, aarch64)
 PSCI_LIB_SOURCES	+=	lib/el3_runtime/aarch64/context.S
 endif
 
+ifeq (${SPINLOCK_STATS}, 1)
+PSCI_LIB_SOURCES		+=	lib/locks/exclusive/spinlock_stats.c
+endif
+
+ifeq (${HW_ASSISTED_COHERENCY}-${PSCI_QUEUED_LOCKS}, 1-1)
+PSCI_LIB_SOURCES		+=	lib/locks/exclusive/${ARCH}/mcs_lock.S
+endif
+
 ifeq (${USE_COHERENT_MEM}, 1)
 PSCI_LIB_SOURCES		+=	lib/locks/bakery/bakery_lock_coherent.c
 else
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -30,6 +30,54 @@ static inline void psci_spin_unlock_cpu(unsigned int idx)
 	spin_unlock(&psci_cpu_pd_nodes[idx].cpu_lock);
 }
 
+#if PARALLEL_CPU_ON
+/* Generic timer count at PSCI setup and number of CPUs booted since then */
+static uint64_t psci_boot_start;
+static unsigned int psci_cpus_booted;
+static spinlock_t psci_boot_lock;
+
+void __init psci_boot_timing_start(void)
+{
+	psci_boot_start = read_cntpct_el0();
+	psci_cpus_booted = 1U;
+}
+
+static uint64_t psci_ticks_to_us(uint64_t ticks, uint64_t freq)
+{
+	return ((ticks / freq) * 1000000U) + (((ticks % freq) * 1000000U) / freq);
+}
+
+/*
+ * Account a CPU powered on for the first time and report how long it took for
+ * all the CPUs to come online when the last one has booted.
+ */
+static void psci_boot_timing_cpu_on(unsigned int cpu_idx)
+{
+	uint64_t now, freq;
+	unsigned int booted;
+
+	if (psci_cpu_pd_nodes[cpu_idx].mpidr != PSCI_INVALID_MPIDR) {
+		return;
+	}
+
+	now = read_cntpct_el0();
+
+	spin_lock(&psci_boot_lock);
+	psci_cpus_booted++;
+	booted = psci_cpus_booted;
+	spin_unlock(&psci_boot_lock);
+
+	if (booted == psci_plat_core_count) {
+		freq = read_cntfrq_el0();
+		INFO("PSCI: all %u CPUs online %llu us after PSCI setup, %llu us after reset\n",
+		     booted,
+		     (unsigned long long)psci_ticks_to_us(now - psci_boot_start,
+							  freq),
+		     (unsigned long long)psci_ticks_to_us(now, freq));
+	}
+}
+#endif /* PARALLEL_CPU_ON */
+
 /*******************************************************************************
  * This function checks whether a cpu which has been requested to be turned on
  * is OFF to begin with.
@@ -191,6 +239,22 @@ void psci_cpu_on_finish(unsigned int cpu_idx, const psci_power_state_t *state_in
 	if (psci_plat_pm_ops->pwr_domain_on_finish_late != NULL)
 		psci_plat_pm_ops->pwr_domain_on_finish_late(state_info);
 
+	/* Ensure we have been explicitly woken up by another cpu */
+	assert(psci_get_aff_info_state() == AFF_STATE_ON_PENDING);
+
+#if !PARALLEL_CPU_ON
+	psci_cpu_on_finish_local(cpu_idx);
+#endif
+}
+
+/*******************************************************************************
+ * The following function finishes the part of a power on request that only
+ * concerns this CPU. With PARALLEL_CPU_ON, it is called by the common finisher
+ * routine after the power domain locks have been released, so that CPUs of the
+ * same power domain can complete their CPU_ON requests concurrently.
+ ******************************************************************************/
+void psci_cpu_on_finish_local(unsigned int cpu_idx)
+{
 	/*
 	 * All the platform specific actions for turning this cpu
 	 * on have completed. Perform enough arch.initialization
@@ -207,9 +271,6 @@ void psci_cpu_on_finish(unsigned int cpu_idx, const psci_power_state_t *state_in
 	psci_spin_lock_cpu(cpu_idx);
 	psci_spin_unlock_cpu(cpu_idx);
 
-	/* Ensure we have been explicitly woken up by another cpu */
-	assert(psci_get_aff_info_state() == AFF_STATE_ON_PENDING);
-
 	/*
 	 * Call the cpu on finish handler registered by the Secure Payload
 	 * Dispatcher to let it do any bookeeping. If the handler encounters an
@@ -220,6 +281,10 @@ void psci_cpu_on_finish(unsigned int cpu_idx, const psci_power_state_t *state_in
 
 	PUBLISH_EVENT(psci_cpu_on_finish);
 
+#if PARALLEL_CPU_ON
+	psci_boot_timing_cpu_on(cpu_idx);
+#endif
+
 	/* Populate the mpidr field within the cpu node array */
 	/* This needs to be done only once */
 	psci_cpu_pd_nodes[cpu_idx].mpidr = read_mpidr() & MPIDR_AFFINITY_MASK;
@@ -230,4 +295,13 @@ void psci_cpu_on_finish(unsigned int cpu_idx, const psci_power_state_t *state_in
 	 * call to set this cpu on its way.
 	 */
 	cm_prepare_el3_exit(NON_SECURE);
+
+#if PARALLEL_CPU_ON
+	/*
+	 * The secure and EL3 contexts of this CPU are complete, so it can now
+	 * be reported ON to AFFINITY_INFO.
+	 */
+	psci_set_aff_info_state(AFF_STATE_ON);
+	psci_flush_cpu_data(psci_svc_cpu_data.aff_info_state);
+#endif
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -14,6 +14,7 @@
 #include <common/bl_common.h>
 #include <lib/bakery_lock.h>
 #include <lib/el3_runtime/cpu_data.h>
+#include <lib/mcs_lock.h>
 #include <lib/psci/psci.h>
 #include <lib/spinlock.h>
 
@@ -164,12 +165,28 @@ typedef struct cpu_pwr_domain_node {
  * The following are helpers and declarations of locks.
  ******************************************************************************/
 #if HW_ASSISTED_COHERENCY
+#if PSCI_QUEUED_LOCKS
+/*
+ * On systems where participant CPUs are cache-coherent, MCS locks can be used
+ * so that each waiting CPU spins on its own queue node. A CPU holds at most one
+ * lock per power level at a time, hence one node per CPU and power level.
+ */
+#define DEFINE_PSCI_LOCK(_name)		mcs_lock_t _name
+#define DECLARE_PSCI_LOCK(_name)	extern DEFINE_PSCI_LOCK(_name)
+
+typedef struct psci_lock_nodes {
+	mcs_node_t node[PLAT_MAX_PWR_LVL];
+} __aligned(CACHE_WRITEBACK_GRANULE) psci_lock_nodes_t;
+
+extern psci_lock_nodes_t psci_lock_nodes[PLATFORM_CORE_COUNT];
+#else
 /*
  * On systems where participant CPUs are cache-coherent, we can use spinlocks
  * instead of bakery locks.
  */
 #define DEFINE_PSCI_LOCK(_name)		spinlock_t _name
 #define DECLARE_PSCI_LOCK(_name)	extern DEFINE_PSCI_LOCK(_name)
+#endif /* PSCI_QUEUED_LOCKS */
 
 /* One lock is required per non-CPU power domain node */
 DECLARE_PSCI_LOCK(psci_locks[PSCI_NUM_NON_CPU_PWR_DOMAINS]);
@@ -193,6 +210,24 @@ static inline void psci_dsbish(void)
 	/* Empty */
 }
 
+#if PSCI_QUEUED_LOCKS
+static inline mcs_node_t *psci_lock_node(non_cpu_pd_node_t *non_cpu_pd_node)
+{
+	return &psci_lock_nodes[plat_my_core_pos()].node[non_cpu_pd_node->level - 1U];
+}
+
+static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
+{
+	mcs_lock_get(&psci_locks[non_cpu_pd_node->lock_index],
+		     psci_lock_node(non_cpu_pd_node));
+}
+
+static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
+{
+	mcs_lock_release(&psci_locks[non_cpu_pd_node->lock_index],
+			 psci_lock_node(non_cpu_pd_node));
+}
+#else
 static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
 {
 	spin_lock(&psci_locks[non_cpu_pd_node->lock_index]);
@@ -202,6 +237,7 @@ static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
 {
 	spin_unlock(&psci_locks[non_cpu_pd_node->lock_index]);
 }
+#endif /* PSCI_QUEUED_LOCKS */
 
 #else /* if HW_ASSISTED_COHERENCY == 0 */
 /*
@@ -233,7 +269,19 @@ static inline void psci_dsbish(void)
 
 static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
 {
+#if PSCI_QUEUED_LOCKS
+	/*
+	 * Exclusive accesses cannot be relied upon before the CPU has joined
+	 * the coherency domain, so stay with bakery locks. Only the CPUs below
+	 * this power domain node can contend for its lock, so limit the
+	 * bakery scan to them.
+	 */
+	bakery_lock_get_range(&psci_locks[non_cpu_pd_node->lock_index],
+			      non_cpu_pd_node->cpu_start_idx,
+			      non_cpu_pd_node->ncpus);
+#else
 	bakery_lock_get(&psci_locks[non_cpu_pd_node->lock_index]);
+#endif
 }
 
 static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
@@ -307,6 +355,10 @@ int psci_cpu_on_start(u_register_t target_cpu,
 		      const entry_point_info_t *ep);
 
 void psci_cpu_on_finish(unsigned int cpu_idx, const psci_power_state_t *state_info);
+void psci_cpu_on_finish_local(unsigned int cpu_idx);
+#if PARALLEL_CPU_ON
+void psci_boot_timing_start(void);
+#endif
 
 /* Private exported functions from psci_off.c */
 int psci_do_cpu_off(unsigned int end_pwrlvl);
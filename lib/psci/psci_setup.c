@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2013-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -221,6 +221,10 @@ int __init psci_setup(const psci_lib_args_t *lib_args)
 	psci_cpu_pd_nodes[plat_my_core_pos()].mpidr =
 		read_mpidr() & MPIDR_AFFINITY_MASK;
 
+#if PARALLEL_CPU_ON
+	psci_boot_timing_start();
+#endif
+
 	psci_init_req_local_pwr_states();
 
 	/*
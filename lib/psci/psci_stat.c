@@ -1,14 +1,17 @@
 /*
- * Copyright (c) 2016-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <string.h>
 
 #include <platform_def.h>
 
+#include <arch_helpers.h>
 #include <common/debug.h>
+#include <lib/psci/psci_lib.h>
 #include <plat/common/platform.h>
 
 #include "psci_private.h"
@@ -30,14 +33,52 @@ typedef struct psci_stat {
 static int last_cpu_in_non_cpu_pd[PSCI_NUM_NON_CPU_PWR_DOMAINS] = {
 		[0 ... PSCI_NUM_NON_CPU_PWR_DOMAINS - 1U] = -1};
 
+/*
+ * The PSCI STAT values of a power domain. They are only updated by one CPU at
+ * a time: the CPU itself for a CPU power domain and the holder of the power
+ * domain lock otherwise. The sequence counter is odd while an update is in
+ * progress, so readers can retry instead of blocking the updating CPU.
+ */
+typedef struct psci_stat_set {
+	unsigned int seq;
+	psci_stat_t stat[PLAT_MAX_PWR_LVL_STATES];
+} psci_stat_set_t;
+
 /*
  * Following are used to store PSCI STAT values for
  * CPU and non CPU power domains.
  */
-static psci_stat_t psci_cpu_stat[PLATFORM_CORE_COUNT]
-				[PLAT_MAX_PWR_LVL_STATES];
-static psci_stat_t psci_non_cpu_stat[PSCI_NUM_NON_CPU_PWR_DOMAINS]
-				[PLAT_MAX_PWR_LVL_STATES];
+static psci_stat_set_t psci_cpu_stat[PLATFORM_CORE_COUNT];
+static psci_stat_set_t psci_non_cpu_stat[PSCI_NUM_NON_CPU_PWR_DOMAINS];
+
+/* Add the residency of one more visit to a local power state */
+static void psci_stat_add(psci_stat_set_t *set, int stat_idx,
+			  u_register_t residency)
+{
+	set->seq++;
+	dmbishst();
+
+	set->stat[stat_idx].residency += residency;
+	set->stat[stat_idx].count++;
+
+	dmbishst();
+	set->seq++;
+}
+
+/* Read a consistent copy of the PSCI STAT values of a power domain */
+static void psci_stat_read(const psci_stat_set_t *set,
+			   psci_stat_t stat[PLAT_MAX_PWR_LVL_STATES])
+{
+	const volatile unsigned int *seq = &set->seq;
+	unsigned int start;
+
+	do {
+		start = *seq;
+		dmbish();
+		(void)memcpy(stat, set->stat, sizeof(set->stat));
+		dmbish();
+	} while (((start & 1U) != 0U) || (*seq != start));
+}
 
 /*
  * This functions returns the index into the `psci_stat_t` array given the
@@ -127,8 +168,7 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 	    state_info, cpu_idx);
 
 	/* Update CPU stats. */
-	psci_cpu_stat[cpu_idx][stat_idx].residency += residency;
-	psci_cpu_stat[cpu_idx][stat_idx].count++;
+	psci_stat_add(&psci_cpu_stat[cpu_idx], stat_idx, residency);
 
 	/*
 	 * Check what power domains above CPU were off
@@ -159,8 +199,8 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 		stat_idx = get_stat_idx(local_state, lvl);
 
 		/* Update non cpu stats */
-		psci_non_cpu_stat[parent_idx][stat_idx].residency += residency;
-		psci_non_cpu_stat[parent_idx][stat_idx].count++;
+		psci_stat_add(&psci_non_cpu_stat[parent_idx], stat_idx,
+			      residency);
 
 		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 	}
@@ -180,6 +220,7 @@ static int psci_get_stat(u_register_t target_cpu, unsigned int power_state,
 	int stat_idx;
 	psci_power_state_t state_info = { {PSCI_LOCAL_STATE_RUN} };
 	plat_local_state_t local_state;
+	psci_stat_t stat[PLAT_MAX_PWR_LVL_STATES];
 
 	/* Validate the target_cpu parameter and determine the cpu index */
 	target_idx = (unsigned int) plat_core_pos_by_mpidr(target_cpu);
@@ -214,12 +255,14 @@ static int psci_get_stat(u_register_t target_cpu, unsigned int power_state,
 			parent_idx = SPECULATION_SAFE_VALUE(psci_non_cpu_pd_nodes[parent_idx].parent_node);
 
 		/* Get the non cpu power domain stats */
-		*psci_stat = psci_non_cpu_stat[parent_idx][stat_idx];
+		psci_stat_read(&psci_non_cpu_stat[parent_idx], stat);
 	} else {
 		/* Get the cpu power domain stats */
-		*psci_stat = psci_cpu_stat[target_idx][stat_idx];
+		psci_stat_read(&psci_cpu_stat[target_idx], stat);
 	}
 
+	*psci_stat = stat[stat_idx];
+
 	return PSCI_E_SUCCESS;
 }
 
@@ -248,3 +291,59 @@ u_register_t psci_stat_count(u_register_t target_cpu,
 	else
 		return 0;
 }
+
+#if PSCI_STAT_SNAPSHOT
+/* Size of the block written by psci_stat_snapshot() */
+size_t psci_stat_snapshot_size(void)
+{
+	return sizeof(psci_stat_snapshot_hdr_t) +
+	       (PLATFORM_CORE_COUNT * sizeof(uint64_t)) +
+	       ((PLATFORM_CORE_COUNT + PSCI_NUM_NON_CPU_PWR_DOMAINS) *
+		PLAT_MAX_PWR_LVL_STATES * sizeof(psci_stat_snapshot_entry_t));
+}
+
+/*******************************************************************************
+ * This function writes the PSCI STAT values of every power domain to 'dst':
+ * a header, the MPIDR of each CPU, then the values of each CPU and each non
+ * CPU power domain, in the order of the power domain tree. The values of each
+ * power domain are consistent with each other, but the power domains are read
+ * one after the other without stopping the updates.
+ ******************************************************************************/
+void psci_stat_snapshot(void *dst)
+{
+	psci_stat_snapshot_hdr_t *hdr = dst;
+	uint64_t *mpidr = (uint64_t *)(hdr + 1);
+	psci_stat_snapshot_entry_t *entry;
+	psci_stat_t stat[PLAT_MAX_PWR_LVL_STATES];
+	unsigned int i, j;
+
+	hdr->version = PSCI_STAT_SNAPSHOT_VERSION;
+	hdr->num_cpus = PLATFORM_CORE_COUNT;
+	hdr->num_non_cpu_pds = PSCI_NUM_NON_CPU_PWR_DOMAINS;
+	hdr->num_states = PLAT_MAX_PWR_LVL_STATES;
+
+	for (i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		mpidr[i] = psci_cpu_pd_nodes[i].mpidr;
+	}
+
+	entry = (psci_stat_snapshot_entry_t *)(mpidr + PLATFORM_CORE_COUNT);
+
+	for (i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		psci_stat_read(&psci_cpu_stat[i], stat);
+		for (j = 0U; j < PLAT_MAX_PWR_LVL_STATES; j++) {
+			entry->residency = stat[j].residency;
+			entry->count = stat[j].count;
+			entry++;
+		}
+	}
+
+	for (i = 0U; i < PSCI_NUM_NON_CPU_PWR_DOMAINS; i++) {
+		psci_stat_read(&psci_non_cpu_stat[i], stat);
+		for (j = 0U; j < PLAT_MAX_PWR_LVL_STATES; j++) {
+			entry->residency = stat[j].residency;
+			entry->count = stat[j].count;
+			entry++;
+		}
+	}
+}
+#endif /* PSCI_STAT_SNAPSHOT */
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <lib/utils.h>
+#include <lib/utils_def.h>
+
+#include <platform_def.h>
+
+/* Size of the buffer zeroed by the benchmark */
+#ifndef ZERO_MEM_BENCHMARK_SIZE
+#define ZERO_MEM_BENCHMARK_SIZE		U(0x4000)
+#endif
+
+/* Number of times the buffer is zeroed for each routine */
+#define ZERO_MEM_BENCHMARK_ITERATIONS	U(16)
+
+static uint8_t bench_buf[ZERO_MEM_BENCHMARK_SIZE] __aligned(CACHE_WRITEBACK_GRANULE);
+
+static void zero_with_zeromem(void *mem, size_t length)
+{
+	zeromem(mem, length);
+}
+
+static void zero_with_zero_normalmem(void *mem, size_t length)
+{
+	zero_normalmem(mem, length);
+}
+
+static void zero_with_memset(void *mem, size_t length)
+{
+	(void)memset(mem, 0, length);
+}
+
+static void bench_one(const char *name, void (*zero)(void *, size_t),
+		      uint64_t freq)
+{
+	uint64_t bytes = (uint64_t)ZERO_MEM_BENCHMARK_SIZE *
+			 ZERO_MEM_BENCHMARK_ITERATIONS;
+	uint64_t start, ticks, centi_bytes_per_tick;
+	unsigned int i;
+
+	/* Warm up the caches and the TLBs */
+	zero(bench_buf, sizeof(bench_buf));
+
+	isb();
+	start = read_cntpct_el0();
+	for (i = 0U; i < ZERO_MEM_BENCHMARK_ITERATIONS; i++) {
+		zero(bench_buf, sizeof(bench_buf));
+	}
+	dsbsy();
+	isb();
+	ticks = read_cntpct_el0() - start;
+	if (ticks == 0U) {
+		ticks = 1U;
+	}
+
+	centi_bytes_per_tick = (bytes * 100U) / ticks;
+	INFO("  %s: %llu ticks, %llu.%02llu bytes/tick, %llu MiB/s\n",
+	     name, (unsigned long long)ticks,
+	     (unsigned long long)(centi_bytes_per_tick / 100U),
+	     (unsigned long long)(centi_bytes_per_tick % 100U),
+	     (unsigned long long)(((bytes * freq) / ticks) >> 20));
+}
+
+/*
+ * Measure the throughput of the routines used to zero memory. The generic
+ * timer is used as the time base, so the results are reported in bytes per
+ * timer tick and in MiB/s rather than in bytes per CPU cycle. It must be
+ * called with the MMU and data cache enabled.
+ */
+void zero_mem_benchmark(void)
+{
+	uint64_t freq = read_cntfrq_el0();
+	u_register_t dczid = read_dczid_el0();
+
+	INFO("Zeroing benchmark: %u bytes x %u, timer at %llu Hz\n",
+	     ZERO_MEM_BENCHMARK_SIZE, ZERO_MEM_BENCHMARK_ITERATIONS,
+	     (unsigned long long)freq);
+	if ((dczid & DCZID_DZP_BIT) != 0U) {
+		INFO("  DC ZVA is prohibited\n");
+	} else {
+		INFO("  DC ZVA block size: %u bytes\n",
+		     4U << (unsigned int)(dczid & DCZID_BS_MASK));
+	}
+
+	bench_one("zeromem", zero_with_zeromem, freq);
+	bench_one("zero_normalmem", zero_with_zero_normalmem, freq);
+	bench_one("memset", zero_with_memset, freq);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <arch_features.h>
+
+#include "zutil.h"
+
+/* Only the first table of crc32.h is needed for the byte-wise fallback */
+#define TBLS	1
+#include "crc32.h"
+
+uint32_t tf_crc32_armv8(uint32_t crc, const unsigned char *buf, size_t len);
+
+/*
+ * Replacement for crc32.c on AArch64. The CRC is computed with the FEAT_CRC32
+ * instructions when the CPU implements them, otherwise one byte at a time.
+ * Only crc32() and crc32_z() are provided, as they are all that inflate needs.
+ */
+unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
+			      z_size_t len)
+{
+	uint32_t c;
+
+	if (buf == Z_NULL)
+		return 0UL;
+
+	c = (uint32_t)crc ^ 0xffffffffU;
+
+	if (is_armv8_1_crc32_present()) {
+		c = tf_crc32_armv8(c, buf, len);
+	} else {
+		while (len-- != 0U)
+			c = crc_table[0][(c ^ *buf++) & 0xffU] ^ (c >> 8);
+	}
+
+	return (unsigned long)(c ^ 0xffffffffU);
+}
+
+unsigned long ZEXPORT crc32(unsigned long crc, const unsigned char FAR *buf,
+			    uInt len)
+{
+	return crc32_z(crc, buf, len);
+}
@@ -1,13 +1,15 @@
 /*
- * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2018-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <string.h>
 
+#include <arch_helpers.h>
 #include <common/debug.h>
 #include <lib/utils.h>
 #include <tf_gunzip.h>
@@ -47,6 +49,48 @@ static void ZLIB_INTERNAL zfree(void *opaque, void *ptr)
 {
 }
 
+static int gunzip_init(z_stream *stream, uintptr_t out_buf, size_t out_len,
+		       uintptr_t work_buf, size_t work_len)
+{
+	int zret;
+
+	zalloc_start = work_buf;
+	zalloc_end = work_buf + work_len;
+	zalloc_current = zalloc_start;
+
+	stream->next_in = Z_NULL;
+	stream->avail_in = 0;
+	stream->next_out = (typeof(stream->next_out))out_buf;
+	stream->avail_out = out_len;
+	stream->zalloc = zcalloc;
+	stream->zfree = zfree;
+	stream->opaque = (voidpf)0;
+
+	zret = inflateInit(stream);
+	if (zret != Z_OK) {
+		ERROR("zlib: inflate init failed (ret = %d)\n", zret);
+		return (zret == Z_MEM_ERROR) ? -ENOMEM : -EIO;
+	}
+
+	return 0;
+}
+
+/* Report the time spent in inflate(), from generic timer ticks */
+static void gunzip_report_time(uint64_t ticks)
+{
+	VERBOSE("zlib: inflated in %llu us\n",
+		(unsigned long long)((ticks * 1000000U) / read_cntfrq_el0()));
+}
+
+static int gunzip_error(z_stream *stream, int zret)
+{
+	if (stream->msg)
+		ERROR("%s\n", stream->msg);
+	ERROR("zlib: inflate failed (ret = %d)\n", zret);
+
+	return (zret == Z_MEM_ERROR) ? -ENOMEM : -EIO;
+}
+
 /*
  * gunzip - decompress gzip data
  * @in_buf: source of compressed input. Upon exit, the end of input.
@@ -60,35 +104,23 @@ int gunzip(uintptr_t *in_buf, size_t in_len, uintptr_t *out_buf,
 	   size_t out_len, uintptr_t work_buf, size_t work_len)
 {
 	z_stream stream;
+	uint64_t start;
 	int zret, ret;
 
-	zalloc_start = work_buf;
-	zalloc_end = work_buf + work_len;
-	zalloc_current = zalloc_start;
+	ret = gunzip_init(&stream, *out_buf, out_len, work_buf, work_len);
+	if (ret != 0)
+		return ret;
 
 	stream.next_in = (typeof(stream.next_in))*in_buf;
 	stream.avail_in = in_len;
-	stream.next_out = (typeof(stream.next_out))*out_buf;
-	stream.avail_out = out_len;
-	stream.zalloc = zcalloc;
-	stream.zfree = zfree;
-	stream.opaque = (voidpf)0;
-
-	zret = inflateInit(&stream);
-	if (zret != Z_OK) {
-		ERROR("zlib: inflate init failed (ret = %d)\n", zret);
-		return (zret == Z_MEM_ERROR) ? -ENOMEM : -EIO;
-	}
 
+	start = read_cntpct_el0();
 	zret = inflate(&stream, Z_NO_FLUSH);
-	if (zret == Z_STREAM_END) {
+	gunzip_report_time(read_cntpct_el0() - start);
+	if (zret == Z_STREAM_END)
 		ret = 0;
-	} else {
-		if (stream.msg)
-			ERROR("%s\n", stream.msg);
-		ERROR("zlib: inflate failed (ret = %d)\n", zret);
-		ret = (zret == Z_MEM_ERROR) ? -ENOMEM : -EIO;
-	}
+	else
+		ret = gunzip_error(&stream, zret);
 
 	VERBOSE("zlib: %lu byte input\n", stream.total_in);
 	VERBOSE("zlib: %lu byte output\n", stream.total_out);
@@ -100,3 +132,95 @@ int gunzip(uintptr_t *in_buf, size_t in_len, uintptr_t *out_buf,
 
 	return ret;
 }
+
+/*
+ * Streaming variant of gunzip(), for compressed data that is not available in
+ * a single buffer. The input is fed in chunks of any size, in order, and the
+ * chunks do not need to be kept once they are consumed. Only one stream can
+ * be in progress at a time.
+ */
+static z_stream gunzip_stream;
+static bool gunzip_stream_done;
+static uint64_t gunzip_stream_ticks;
+
+/*
+ * gunzip_stream_init - start decompressing gzip data
+ * @out_buf: destination of decompressed output
+ * @out_len: length of out_buf
+ * @work_buf: workspace, which also holds the 32KB inflate window
+ * @work_len: length of workspace
+ */
+int gunzip_stream_init(uintptr_t out_buf, size_t out_len, uintptr_t work_buf,
+		       size_t work_len)
+{
+	gunzip_stream_done = false;
+	gunzip_stream_ticks = 0U;
+
+	return gunzip_init(&gunzip_stream, out_buf, out_len, work_buf,
+			   work_len);
+}
+
+/*
+ * gunzip_stream_update - decompress the next chunk of gzip data
+ * @in_buf: chunk of compressed input
+ * @in_len: length of in_buf
+ *
+ * Any data following the end of the gzip stream is ignored.
+ */
+int gunzip_stream_update(uintptr_t in_buf, size_t in_len)
+{
+	uint64_t start;
+	int zret, ret;
+
+	if (gunzip_stream_done || (in_len == 0U))
+		return 0;
+
+	gunzip_stream.next_in = (typeof(gunzip_stream.next_in))in_buf;
+	gunzip_stream.avail_in = in_len;
+
+	start = read_cntpct_el0();
+	zret = inflate(&gunzip_stream, Z_NO_FLUSH);
+	gunzip_stream_ticks += read_cntpct_el0() - start;
+	if (zret == Z_STREAM_END) {
+		gunzip_stream_done = true;
+		return 0;
+	}
+
+	/* Input left over without an error means that the output is full */
+	if ((zret == Z_OK) && (gunzip_stream.avail_in != 0U))
+		zret = Z_BUF_ERROR;
+
+	if (zret != Z_OK) {
+		ret = gunzip_error(&gunzip_stream, zret);
+		inflateEnd(&gunzip_stream);
+		return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * gunzip_stream_finish - complete the decompression
+ * @out_buf: upon exit, the end of output
+ *
+ * Fails if the input fed so far did not contain the whole gzip stream.
+ */
+int gunzip_stream_finish(uintptr_t *out_buf)
+{
+	int ret = 0;
+
+	if (!gunzip_stream_done) {
+		ERROR("zlib: truncated input\n");
+		ret = -EIO;
+	}
+
+	VERBOSE("zlib: %lu byte input\n", gunzip_stream.total_in);
+	VERBOSE("zlib: %lu byte output\n", gunzip_stream.total_out);
+	gunzip_report_time(gunzip_stream_ticks);
+
+	*out_buf = (uintptr_t)gunzip_stream.next_out;
+
+	inflateEnd(&gunzip_stream);
+
+	return ret;
+}
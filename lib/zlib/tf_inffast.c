@@ -0,0 +1,359 @@
+/* tf_inffast.c -- fast decoding for 64-bit targets
+ * Copyright (C) 1995-2017 Mark Adler
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Derived from inffast.c of zlib 1.2.11 for TF, as a replacement for it on
+ * AArch64:
+ * - The bit buffer is 64-bit wide and is refilled with 8 bytes at once, once
+ *   per literal or length/distance pair instead of up to four times.
+ * - When unaligned accesses are allowed, matches are copied 8 bytes at a time.
+ * The target is assumed to be little-endian.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "zutil.h"
+#include "inftrees.h"
+#include "inflate.h"
+#include "inffast.h"
+
+#ifdef __ARM_FEATURE_UNALIGNED
+#  define TF_WIDE_ACCESS
+#endif
+
+/*
+   Number of bits needed in the bit buffer to decode a length/distance pair:
+   15 bits for the length code, 5 bits for the length extra, 15 bits for the
+   distance code and 13 bits for the distance extra.
+ */
+#define PAIR_BITS 48
+
+#ifdef TF_WIDE_ACCESS
+/* Bytes of input that load64() may access */
+#define LOAD64_BYTES 8
+
+local uint64_t load64(const unsigned char FAR *p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+#else
+#define LOAD64_BYTES 16
+
+/*
+   Only aligned accesses are allowed: merge the two aligned words that hold
+   the 8 bytes at p, all of which lie within the 16 bytes at p.
+ */
+local uint64_t load64(const unsigned char FAR *p)
+{
+    const unsigned char FAR *w = (const unsigned char FAR *)
+                                 ((uintptr_t)p & ~(uintptr_t)7);
+    unsigned shift = (unsigned)((uintptr_t)p & 7) << 3;
+    uint64_t lo, hi;
+
+    memcpy(&lo, __builtin_assume_aligned(w, 8), sizeof(lo));
+    if (shift == 0)
+        return lo;
+    memcpy(&hi, __builtin_assume_aligned(w + 8, 8), sizeof(hi));
+    return (lo >> shift) | (hi << (64 - shift));
+}
+#endif
+
+/*
+   Copy len bytes from from to out, where out - from == dist if they are in
+   the same buffer. Bytes written by the copy may be read again later in the
+   same copy when dist is less than len, so 8-byte chunks are only used if
+   dist >= 8.
+ */
+local unsigned char FAR *copy_match(unsigned char FAR *out,
+                                    const unsigned char FAR *from,
+                                    unsigned len, unsigned dist)
+{
+#ifdef TF_WIDE_ACCESS
+    uint64_t v;
+
+    if (dist >= 8) {
+        while (len >= 8) {
+            v = load64(from);
+            memcpy(out, &v, sizeof(v));
+            out += 8;
+            from += 8;
+            len -= 8;
+        }
+    }
+#endif
+    while (len > 2) {
+        *out++ = *from++;
+        *out++ = *from++;
+        *out++ = *from++;
+        len -= 3;
+    }
+    if (len) {
+        *out++ = *from++;
+        if (len > 1)
+            *out++ = *from++;
+    }
+    return out;
+}
+
+/*
+   Decode literal, length, and distance codes and write out the resulting
+   literal and match bytes until either not enough input or output is
+   available, an end-of-block is encountered, or a data error is encountered.
+
+   Entry assumptions:
+
+        state->mode == LEN
+        strm->avail_in >= 6
+        strm->avail_out >= 258
+        start >= strm->avail_out
+        state->bits < 8
+
+   On return, state->mode is one of:
+
+        LEN -- ran out of enough output space or enough available input
+        TYPE -- reached end of block code, inflate() to interpret next block
+        BAD -- error in block data
+
+   Notes:
+
+    - The bit buffer is refilled to at least PAIR_BITS bits at the start of
+      each loop, which takes at most six bytes. Therefore if
+      strm->avail_in >= 6, then there is enough input to avoid checking for
+      available input while decoding.
+
+    - An 8-byte refill may leave in the bit buffer, above the valid bits,
+      some bits of the next input byte. They are always the same as the bits
+      the next refill puts there, so the buffer is refilled with OR rather
+      than addition, and they are discarded on return.
+
+    - The maximum bytes that a single length/distance pair can output is 258
+      bytes, which is the maximum length that can be coded.  inflate_fast()
+      requires strm->avail_out >= 258 for each loop to avoid checking for
+      output space.
+ */
+void ZLIB_INTERNAL inflate_fast(strm, start)
+z_streamp strm;
+unsigned start;         /* inflate()'s starting value for strm->avail_out */
+{
+    struct inflate_state FAR *state;
+    z_const unsigned char FAR *in;      /* local strm->next_in */
+    z_const unsigned char FAR *last;    /* have enough input while in < last */
+    z_const unsigned char FAR *in_end;  /* end of the input */
+    unsigned char FAR *out;     /* local strm->next_out */
+    unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
+    unsigned char FAR *end;     /* while out < end, enough space available */
+#ifdef INFLATE_STRICT
+    unsigned dmax;              /* maximum distance from zlib header */
+#endif
+    unsigned wsize;             /* window size or zero if not using window */
+    unsigned whave;             /* valid bytes in the window */
+    unsigned wnext;             /* window write index */
+    unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    uint64_t hold;              /* local strm->hold */
+    unsigned bits;              /* local strm->bits */
+    code const FAR *lcode;      /* local strm->lencode */
+    code const FAR *dcode;      /* local strm->distcode */
+    unsigned lmask;             /* mask for first level of length codes */
+    unsigned dmask;             /* mask for first level of distance codes */
+    code here;                  /* retrieved table entry */
+    unsigned op;                /* code bits, operation, extra bits, or */
+                                /*  window position, window bytes to copy */
+    unsigned len;               /* match length, unused bytes */
+    unsigned dist;              /* match distance */
+    unsigned char FAR *from;    /* where to copy match from */
+
+    /* copy state to local variables */
+    state = (struct inflate_state FAR *)strm->state;
+    in = strm->next_in;
+    last = in + (strm->avail_in - 5);
+    in_end = in + strm->avail_in;
+    out = strm->next_out;
+    beg = out - (start - strm->avail_out);
+    end = out + (strm->avail_out - 257);
+#ifdef INFLATE_STRICT
+    dmax = state->dmax;
+#endif
+    wsize = state->wsize;
+    whave = state->whave;
+    wnext = state->wnext;
+    window = state->window;
+    hold = state->hold;
+    bits = state->bits;
+    lcode = state->lencode;
+    dcode = state->distcode;
+    lmask = (1U << state->lenbits) - 1;
+    dmask = (1U << state->distbits) - 1;
+
+    /* decode literals and length/distances until end-of-block or not enough
+       input data or output space */
+    do {
+        if (bits < PAIR_BITS) {
+            if (in_end - in >= LOAD64_BYTES) {
+                hold |= load64(in) << bits;
+                in += (63 - bits) >> 3;
+                bits |= 56;
+            }
+            else {
+                do {
+                    hold |= (uint64_t)(*in++) << bits;
+                    bits += 8;
+                } while (bits < PAIR_BITS);
+            }
+        }
+        here = lcode[hold & lmask];
+      dolen:
+        op = (unsigned)(here.bits);
+        hold >>= op;
+        bits -= op;
+        op = (unsigned)(here.op);
+        if (op == 0) {                          /* literal */
+            Tracevv((stderr, here.val >= 0x20 && here.val < 0x7f ?
+                    "inflate:         literal '%c'\n" :
+                    "inflate:         literal 0x%02x\n", here.val));
+            *out++ = (unsigned char)(here.val);
+        }
+        else if (op & 16) {                     /* length base */
+            len = (unsigned)(here.val);
+            op &= 15;                           /* number of extra bits */
+            if (op) {
+                len += (unsigned)hold & ((1U << op) - 1);
+                hold >>= op;
+                bits -= op;
+            }
+            Tracevv((stderr, "inflate:         length %u\n", len));
+            here = dcode[hold & dmask];
+          dodist:
+            op = (unsigned)(here.bits);
+            hold >>= op;
+            bits -= op;
+            op = (unsigned)(here.op);
+            if (op & 16) {                      /* distance base */
+                dist = (unsigned)(here.val);
+                op &= 15;                       /* number of extra bits */
+                dist += (unsigned)hold & ((1U << op) - 1);
+#ifdef INFLATE_STRICT
+                if (dist > dmax) {
+                    strm->msg = (char *)"invalid distance too far back";
+                    state->mode = BAD;
+                    break;
+                }
+#endif
+                hold >>= op;
+                bits -= op;
+                Tracevv((stderr, "inflate:         distance %u\n", dist));
+                op = (unsigned)(out - beg);     /* max distance in output */
+                if (dist > op) {                /* see if copy from window */
+                    op = dist - op;             /* distance back in window */
+                    if (op > whave) {
+                        if (state->sane) {
+                            strm->msg =
+                                (char *)"invalid distance too far back";
+                            state->mode = BAD;
+                            break;
+                        }
+#ifdef INFLATE_ALLOW_INVALID_DISTANCE_TOOFAR_ARRR
+                        if (len <= op - whave) {
+                            do {
+                                *out++ = 0;
+                            } while (--len);
+                            continue;
+                        }
+                        len -= op - whave;
+                        do {
+                            *out++ = 0;
+                        } while (--op > whave);
+                        if (op == 0) {
+                            from = out - dist;
+                            do {
+                                *out++ = *from++;
+                            } while (--len);
+                            continue;
+                        }
+#endif
+                    }
+                    /* the window never overlaps the output */
+                    from = window;
+                    if (wnext == 0) {           /* very common case */
+                        from += wsize - op;
+                        if (op < len) {         /* some from window */
+                            len -= op;
+                            out = copy_match(out, from, op, dist);
+                            from = out - dist;  /* rest from output */
+                        }
+                    }
+                    else if (wnext < op) {      /* wrap around window */
+                        from += wsize + wnext - op;
+                        op -= wnext;
+                        if (op < len) {         /* some from end of window */
+                            len -= op;
+                            out = copy_match(out, from, op, dist);
+                            from = window;
+                            if (wnext < len) {  /* some from start of window */
+                                op = wnext;
+                                len -= op;
+                                out = copy_match(out, from, op, dist);
+                                from = out - dist;      /* rest from output */
+                            }
+                        }
+                    }
+                    else {                      /* contiguous in window */
+                        from += wnext - op;
+                        if (op < len) {         /* some from window */
+                            len -= op;
+                            out = copy_match(out, from, op, dist);
+                            from = out - dist;  /* rest from output */
+                        }
+                    }
+                    out = copy_match(out, from, len, dist);
+                }
+                else {
+                    from = out - dist;          /* copy direct from output */
+                    out = copy_match(out, from, len, dist);
+                }
+            }
+            else if ((op & 64) == 0) {          /* 2nd level distance code */
+                here = dcode[here.val + (hold & ((1U << op) - 1))];
+                goto dodist;
+            }
+            else {
+                strm->msg = (char *)"invalid distance code";
+                state->mode = BAD;
+                break;
+            }
+        }
+        else if ((op & 64) == 0) {              /* 2nd level length code */
+            here = lcode[here.val + (hold & ((1U << op) - 1))];
+            goto dolen;
+        }
+        else if (op & 32) {                     /* end-of-block */
+            Tracevv((stderr, "inflate:         end of block\n"));
+            state->mode = TYPE;
+            break;
+        }
+        else {
+            strm->msg = (char *)"invalid literal/length code";
+            state->mode = BAD;
+            break;
+        }
+    } while (in < last && out < end);
+
+    /* return unused bytes (on entry, bits < 8, so in won't go too far back) */
+    len = bits >> 3;
+    in -= len;
+    bits -= len << 3;
+    hold &= ((uint64_t)1 << bits) - 1;
+
+    /* update state and return */
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(in < last ? 5 + (last - in) : 5 - (in - last));
+    strm->avail_out = (unsigned)(out < end ?
+                                 257 + (end - out) : 257 - (out - end));
+    state->hold = (unsigned long)hold;
+    state->bits = bits;
+    return;
+}
@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+# Copyright (c) 2018-2021, ARM Limited and Contributors. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -9,8 +9,6 @@ ZLIB_PATH	:=	lib/zlib
 # Imported from zlib 1.2.11 (do not modify them)
 ZLIB_SOURCES	:=	$(addprefix $(ZLIB_PATH)/,	\
 					adler32.c	\
-					crc32.c		\
-					inffast.c	\
 					inflate.c	\
 					inftrees.c	\
 					zutil.c)
@@ -19,6 +17,19 @@ ZLIB_SOURCES	:=	$(addprefix $(ZLIB_PATH)/,	\
 ZLIB_SOURCES	+=	$(addprefix $(ZLIB_PATH)/,	\
 					tf_gunzip.c)
 
+# On AArch64, crc32.c and inffast.c are replaced by versions using the CRC32
+# instructions and a 64-bit bit buffer
+ifeq (${ARCH},aarch64)
+ZLIB_SOURCES	+=	$(addprefix $(ZLIB_PATH)/,	\
+					aarch64/tf_crc32_armv8.S	\
+					tf_crc32.c	\
+					tf_inffast.c)
+else
+ZLIB_SOURCES	+=	$(addprefix $(ZLIB_PATH)/,	\
+					crc32.c		\
+					inffast.c)
+endif
+
 INCLUDES	+=	-Iinclude/lib/zlib
 
 # REVISIT: the following flags need not be given globally
@@ -0,0 +1,1245 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <common/debug.h>
+#include <lib/utils_def.h>
+#include <tf_unzstd.h>
+
+/*
+ * Decoder for the Zstandard frame format (RFC 8878), as produced by the zstd
+ * command line tool. The whole output is kept in a single buffer, so the
+ * blocks of a frame can refer to each other without a window buffer. The
+ * decoding tables and the literals of the current block are kept in a fixed
+ * arena placed at the start of the workspace, so that nothing is allocated at
+ * runtime. Frames using a dictionary are not supported.
+ *
+ * The target is assumed to be little-endian.
+ */
+
+#define ZSTD_FRAME_MAGIC	U(0xFD2FB528)
+#define ZSTD_SKIPPABLE_MAGIC	U(0x184D2A50)
+#define ZSTD_SKIPPABLE_MASK	U(0xFFFFFFF0)
+
+/* Frame header descriptor */
+#define ZSTD_FHD_FCS_SHIFT	6
+#define ZSTD_FHD_SINGLE_SEGMENT	BIT_32(5)
+#define ZSTD_FHD_RESERVED	BIT_32(3)
+#define ZSTD_FHD_CHECKSUM	BIT_32(2)
+#define ZSTD_FHD_DICT_ID_MASK	U(0x3)
+
+/* Block header */
+#define ZSTD_BLOCK_LAST		BIT_32(0)
+#define ZSTD_BLOCK_TYPE_SHIFT	1
+#define ZSTD_BLOCK_TYPE_MASK	U(0x3)
+#define ZSTD_BLOCK_SIZE_SHIFT	3
+#define ZSTD_BLOCK_RAW		U(0)
+#define ZSTD_BLOCK_RLE		U(1)
+#define ZSTD_BLOCK_COMPRESSED	U(2)
+#define ZSTD_BLOCK_MAX		(128U * 1024U)
+
+/* Literals section */
+#define ZSTD_LIT_RAW		U(0)
+#define ZSTD_LIT_RLE		U(1)
+#define ZSTD_LIT_COMPRESSED	U(2)
+#define ZSTD_LIT_TREELESS	U(3)
+
+/* Huffman coding of the literals */
+#define HUF_MAX_BITS		11U
+#define HUF_MAX_SYMBOLS		256U
+#define HUF_WEIGHTS_MAX_LOG	6U
+
+/* Sequences section */
+#define ZSTD_MODE_PREDEFINED	U(0)
+#define ZSTD_MODE_RLE		U(1)
+#define ZSTD_MODE_FSE		U(2)
+#define ZSTD_MODE_REPEAT	U(3)
+#define ZSTD_LL_SYMBOLS		36U
+#define ZSTD_ML_SYMBOLS		53U
+#define ZSTD_OF_SYMBOLS		32U
+
+/* FSE tables: the largest ones are the literal and match length tables */
+#define FSE_MAX_LOG		9U
+#define FSE_MAX_SYMBOLS		ZSTD_ML_SYMBOLS
+
+/* xxHash64, used by the content checksum */
+#define XXH_PRIME64_1		ULL(0x9E3779B185EBCA87)
+#define XXH_PRIME64_2		ULL(0xC2B2AE3D27D4EB4F)
+#define XXH_PRIME64_3		ULL(0x165667B19E3779F9)
+#define XXH_PRIME64_4		ULL(0x85EBCA77C2B2AE63)
+#define XXH_PRIME64_5		ULL(0x27D4EB2F165667C5)
+
+/* Literal length codes: baseline and number of extra bits */
+static const uint32_t ll_base[ZSTD_LL_SYMBOLS] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048,
+	4096, 8192, 16384, 32768, 65536,
+};
+
+static const uint8_t ll_bits[ZSTD_LL_SYMBOLS] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11,
+	12, 13, 14, 15, 16,
+};
+
+/* Match length codes: baseline and number of extra bits */
+static const uint32_t ml_base[ZSTD_ML_SYMBOLS] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+	19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+	35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027,
+	2051, 4099, 8195, 16387, 32771, 65539,
+};
+
+static const uint8_t ml_bits[ZSTD_ML_SYMBOLS] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10,
+	11, 12, 13, 14, 15, 16,
+};
+
+/* Predefined distributions of the sequence codes */
+static const int16_t ll_default[ZSTD_LL_SYMBOLS] = {
+	4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+	-1, -1, -1, -1,
+};
+
+static const int16_t ml_default[ZSTD_ML_SYMBOLS] = {
+	1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+	-1, -1, -1, -1, -1,
+};
+
+static const int16_t of_default[] = {
+	1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+};
+
+/* Description of the FSE table of one kind of sequence code */
+struct zstd_seq_code {
+	const int16_t *def;
+	unsigned int def_symbols;
+	unsigned int def_log;
+	unsigned int max_symbols;
+	unsigned int max_log;
+};
+
+static const struct zstd_seq_code ll_code = {
+	ll_default, ARRAY_SIZE(ll_default), 6U, ZSTD_LL_SYMBOLS, 9U,
+};
+
+static const struct zstd_seq_code of_code = {
+	of_default, ARRAY_SIZE(of_default), 5U, ZSTD_OF_SYMBOLS, 8U,
+};
+
+static const struct zstd_seq_code ml_code = {
+	ml_default, ARRAY_SIZE(ml_default), 6U, ZSTD_ML_SYMBOLS, 9U,
+};
+
+struct fse_entry {
+	uint16_t baseline;
+	uint8_t symbol;
+	uint8_t bits;
+};
+
+struct fse_table {
+	struct fse_entry entries[1U << FSE_MAX_LOG];
+	unsigned int log;
+	bool valid;
+};
+
+struct huf_entry {
+	uint8_t symbol;
+	uint8_t bits;
+};
+
+/*
+ * Arena placed in the workspace. The tables of a block may be reused by the
+ * following blocks of the same frame.
+ */
+struct zstd_ws {
+	struct fse_table ll;
+	struct fse_table of;
+	struct fse_table ml;
+	struct fse_entry weights_table[1U << HUF_WEIGHTS_MAX_LOG];
+	struct huf_entry huf[1U << HUF_MAX_BITS];
+	unsigned int huf_bits;		/* 0 until a Huffman table is read */
+	uint32_t rep[3];		/* Repeated offsets */
+	uint8_t weights[HUF_MAX_SYMBOLS];
+	uint8_t lit[ZSTD_BLOCK_MAX];
+};
+
+/* Input being parsed: the current position and the end of the data */
+struct zstd_in {
+	const uint8_t *pos;
+	const uint8_t *end;
+};
+
+/*
+ * Backward bit stream: 'pos' is the number of bits left to read. It becomes
+ * negative when more bits than available are read, in which case the missing
+ * bits read as zeros.
+ */
+struct zstd_bits {
+	const uint8_t *data;
+	size_t len;
+	int64_t pos;
+};
+
+static inline uint32_t get_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+	       ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Load up to 8 bytes, as many as available in 'len' */
+static inline uint64_t load_le(const uint8_t *p, size_t len)
+{
+	uint64_t v = 0U;
+	size_t i;
+
+	if (len >= sizeof(v)) {
+		(void)memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	for (i = 0U; i < len; i++) {
+		v |= (uint64_t)p[i] << (8U * i);
+	}
+
+	return v;
+}
+
+static inline unsigned int highbit32(uint32_t v)
+{
+	return 31U - (unsigned int)__builtin_clz(v);
+}
+
+static inline uint64_t rotl64(uint64_t x, unsigned int r)
+{
+	return (x << r) | (x >> (64U - r));
+}
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME64_2;
+	return rotl64(acc, 31U) * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxh64_merge(uint64_t acc, uint64_t v)
+{
+	acc ^= xxh64_round(0U, v);
+	return (acc * XXH_PRIME64_1) + XXH_PRIME64_4;
+}
+
+static uint64_t xxh64(const uint8_t *p, size_t len)
+{
+	const uint8_t *end = p + len;
+	uint64_t v1, v2, v3, v4, h;
+
+	if (len >= 32U) {
+		v1 = XXH_PRIME64_1 + XXH_PRIME64_2;
+		v2 = XXH_PRIME64_2;
+		v3 = 0U;
+		v4 = 0U - XXH_PRIME64_1;
+
+		do {
+			v1 = xxh64_round(v1, load_le(p, 8U));
+			v2 = xxh64_round(v2, load_le(p + 8, 8U));
+			v3 = xxh64_round(v3, load_le(p + 16, 8U));
+			v4 = xxh64_round(v4, load_le(p + 24, 8U));
+			p += 32;
+		} while ((size_t)(end - p) >= 32U);
+
+		h = rotl64(v1, 1U) + rotl64(v2, 7U) + rotl64(v3, 12U) +
+		    rotl64(v4, 18U);
+		h = xxh64_merge(h, v1);
+		h = xxh64_merge(h, v2);
+		h = xxh64_merge(h, v3);
+		h = xxh64_merge(h, v4);
+	} else {
+		h = XXH_PRIME64_5;
+	}
+
+	h += (uint64_t)len;
+
+	while ((size_t)(end - p) >= 8U) {
+		h ^= xxh64_round(0U, load_le(p, 8U));
+		h = (rotl64(h, 27U) * XXH_PRIME64_1) + XXH_PRIME64_4;
+		p += 8;
+	}
+
+	if ((size_t)(end - p) >= 4U) {
+		h ^= (uint64_t)get_le32(p) * XXH_PRIME64_1;
+		h = (rotl64(h, 23U) * XXH_PRIME64_2) + XXH_PRIME64_3;
+		p += 4;
+	}
+
+	while (p < end) {
+		h ^= (uint64_t)*p * XXH_PRIME64_5;
+		h = rotl64(h, 11U) * XXH_PRIME64_1;
+		p++;
+	}
+
+	h ^= h >> 33;
+	h *= XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= XXH_PRIME64_3;
+	h ^= h >> 32;
+
+	return h;
+}
+
+static int zstd_get(struct zstd_in *in, const uint8_t **data, size_t len)
+{
+	if ((size_t)(in->end - in->pos) < len) {
+		ERROR("zstd: truncated input\n");
+		return -EIO;
+	}
+
+	*data = in->pos;
+	in->pos += len;
+
+	return 0;
+}
+
+/* The stream starts at the highest set bit of its last byte */
+static int bits_init(struct zstd_bits *b, const uint8_t *data, size_t len)
+{
+	if ((len == 0U) || (data[len - 1U] == 0U)) {
+		return -EIO;
+	}
+
+	b->data = data;
+	b->len = len;
+	b->pos = (int64_t)(8U * (len - 1U)) + highbit32(data[len - 1U]);
+
+	return 0;
+}
+
+/* Return the next 'n' bits (up to 32) without consuming them */
+static inline uint64_t bits_peek(const struct zstd_bits *b, unsigned int n)
+{
+	int64_t start = b->pos - (int64_t)n;
+	uint64_t v;
+	size_t byte;
+
+	if (n == 0U) {
+		return 0U;
+	}
+
+	if (start >= 0) {
+		byte = (size_t)start >> 3;
+		v = load_le(b->data + byte, b->len - byte) >>
+		    ((unsigned int)start & 7U);
+	} else if (b->pos > 0) {
+		v = load_le(b->data, b->len) << (unsigned int)(-start);
+	} else {
+		return 0U;
+	}
+
+	return v & ((ULL(1) << n) - 1U);
+}
+
+static inline uint32_t bits_read(struct zstd_bits *b, unsigned int n)
+{
+	uint32_t v = (uint32_t)bits_peek(b, n);
+
+	b->pos -= (int64_t)n;
+
+	return v;
+}
+
+/* Read 'n' bits of the forward bit stream of 'len' bytes at 'src' */
+static int fwd_read(const uint8_t *src, size_t len, size_t *pos,
+		    unsigned int n, uint32_t *v)
+{
+	size_t byte = *pos >> 3;
+
+	if ((*pos + n) > (8U * len)) {
+		return -EIO;
+	}
+
+	*v = (uint32_t)(load_le(src + byte, len - byte) >> (*pos & 7U)) &
+	     ((1U << n) - 1U);
+	*pos += n;
+
+	return 0;
+}
+
+/*
+ * Read the FSE table description of at most 'len' bytes at 'src' into the
+ * normalized counts of 'max_symbols' symbols. Return the number of bytes of
+ * the description in 'used'.
+ */
+static int fse_read_counts(const uint8_t *src, size_t len, int16_t *counts,
+			   unsigned int max_symbols, unsigned int max_log,
+			   unsigned int *log, size_t *used)
+{
+	int32_t remaining;
+	unsigned int symbol = 0U;
+	unsigned int nbits, i;
+	uint32_t v, low_mask, threshold, repeat;
+	size_t pos = 0U;
+	int16_t count;
+
+	(void)memset(counts, 0, max_symbols * sizeof(*counts));
+
+	if (fwd_read(src, len, &pos, 4U, &v) != 0) {
+		return -EIO;
+	}
+	*log = v + 5U;
+	if (*log > max_log) {
+		return -EIO;
+	}
+
+	remaining = 1 << *log;
+	while ((remaining > 0) && (symbol < max_symbols)) {
+		nbits = highbit32((uint32_t)remaining + 1U) + 1U;
+		if (fwd_read(src, len, &pos, nbits, &v) != 0) {
+			return -EIO;
+		}
+
+		/* Small values are coded with one bit less */
+		low_mask = (1U << (nbits - 1U)) - 1U;
+		threshold = (1U << nbits) - 1U - ((uint32_t)remaining + 1U);
+		if ((v & low_mask) < threshold) {
+			pos--;
+			v &= low_mask;
+		} else if (v > low_mask) {
+			v -= threshold;
+		}
+
+		/* -1 is a count of less than 1, which takes one state */
+		count = (int16_t)v - 1;
+		remaining -= (count < 0) ? -count : count;
+		counts[symbol++] = count;
+
+		if (count != 0) {
+			continue;
+		}
+
+		/* A zero count is followed by repeat flags of more zeros */
+		do {
+			if (fwd_read(src, len, &pos, 2U, &repeat) != 0) {
+				return -EIO;
+			}
+			for (i = 0U; (i < repeat) && (symbol < max_symbols);
+			     i++) {
+				counts[symbol++] = 0;
+			}
+		} while (repeat == 3U);
+	}
+
+	if (remaining != 0) {
+		return -EIO;
+	}
+
+	*used = (pos + 7U) >> 3;
+
+	return 0;
+}
+
+/* Build the decoding table of 1 << 'log' states for the given counts */
+static int fse_build(struct fse_entry *table, const int16_t *counts,
+		     unsigned int nsymbols, unsigned int log)
+{
+	uint16_t next[FSE_MAX_SYMBOLS];
+	uint32_t size = 1U << log;
+	uint32_t mask = size - 1U;
+	uint32_t step = (size >> 1) + (size >> 3) + 3U;
+	uint32_t high = size;
+	uint32_t pos = 0U;
+	unsigned int s, nbits;
+	uint32_t i;
+	int16_t j;
+
+	/* Symbols of count -1 take the last states */
+	for (s = 0U; s < nsymbols; s++) {
+		if (counts[s] == -1) {
+			table[--high].symbol = (uint8_t)s;
+			next[s] = 1U;
+		}
+	}
+
+	/* The other symbols are spread over the remaining states */
+	for (s = 0U; s < nsymbols; s++) {
+		if (counts[s] <= 0) {
+			continue;
+		}
+		next[s] = (uint16_t)counts[s];
+		for (j = 0; j < counts[s]; j++) {
+			table[pos].symbol = (uint8_t)s;
+			do {
+				pos = (pos + step) & mask;
+			} while (pos >= high);
+		}
+	}
+
+	if (pos != 0U) {
+		return -EIO;
+	}
+
+	for (i = 0U; i < size; i++) {
+		s = table[i].symbol;
+		nbits = log - highbit32(next[s]);
+		table[i].bits = (uint8_t)nbits;
+		table[i].baseline = (uint16_t)(((uint32_t)next[s] << nbits) -
+					       size);
+		next[s]++;
+	}
+
+	return 0;
+}
+
+/* Decode the Huffman weights coded with FSE, two interleaved states */
+static int huf_read_fse_weights(struct zstd_ws *ws, const uint8_t *src,
+				size_t len, unsigned int *nweights)
+{
+	const struct fse_entry *table = ws->weights_table;
+	int16_t counts[HUF_MAX_BITS + 1U];
+	struct zstd_bits b;
+	unsigned int log, n = 0U;
+	uint32_t s1, s2;
+	size_t used;
+
+	if ((fse_read_counts(src, len, counts, ARRAY_SIZE(counts),
+			     HUF_WEIGHTS_MAX_LOG, &log, &used) != 0) ||
+	    (fse_build(ws->weights_table, counts, ARRAY_SIZE(counts),
+		       log) != 0) ||
+	    (bits_init(&b, src + used, len - used) != 0)) {
+		return -EIO;
+	}
+
+	s1 = bits_read(&b, log);
+	s2 = bits_read(&b, log);
+
+	/* The stream ends when a state update runs out of bits */
+	for (;;) {
+		if (n > (HUF_MAX_SYMBOLS - 3U)) {
+			return -EIO;
+		}
+
+		ws->weights[n++] = table[s1].symbol;
+		s1 = table[s1].baseline + bits_read(&b, table[s1].bits);
+		if (b.pos < 0) {
+			ws->weights[n++] = table[s2].symbol;
+			break;
+		}
+
+		ws->weights[n++] = table[s2].symbol;
+		s2 = table[s2].baseline + bits_read(&b, table[s2].bits);
+		if (b.pos < 0) {
+			ws->weights[n++] = table[s1].symbol;
+			break;
+		}
+	}
+
+	*nweights = n;
+
+	return 0;
+}
+
+/*
+ * Read the Huffman tree description at 'src' and build the decoding table,
+ * indexed by the next ws->huf_bits bits of a stream.
+ */
+static int huf_read_table(struct zstd_ws *ws, const uint8_t *src, size_t len,
+			  size_t *used)
+{
+	uint32_t rank_count[HUF_MAX_BITS + 1U] = { 0U };
+	uint32_t rank_idx[HUF_MAX_BITS + 1U];
+	unsigned int n, s, nbits, max_bits;
+	uint32_t sum = 0U, left, i, count;
+	size_t size;
+
+	if (len == 0U) {
+		return -EIO;
+	}
+
+	if (src[0] >= 128U) {
+		/* Weights stored directly, 4 bits each */
+		n = src[0] - 127U;
+		size = (n + 1U) / 2U;
+		if ((len - 1U) < size) {
+			return -EIO;
+		}
+		for (s = 0U; s < n; s++) {
+			ws->weights[s] = ((s & 1U) != 0U) ?
+					 (src[1U + (s / 2U)] & 0xFU) :
+					 (src[1U + (s / 2U)] >> 4);
+		}
+	} else {
+		size = src[0];
+		if (((len - 1U) < size) ||
+		    (huf_read_fse_weights(ws, src + 1, size, &n) != 0)) {
+			return -EIO;
+		}
+	}
+
+	*used = 1U + size;
+
+	/* The weight of the last symbol completes the sum to a power of 2 */
+	for (s = 0U; s < n; s++) {
+		if (ws->weights[s] > HUF_MAX_BITS) {
+			return -EIO;
+		}
+		if (ws->weights[s] != 0U) {
+			sum += 1U << (ws->weights[s] - 1U);
+		}
+	}
+
+	if (sum == 0U) {
+		return -EIO;
+	}
+
+	max_bits = highbit32(sum) + 1U;
+	left = (1U << max_bits) - sum;
+	if ((max_bits > HUF_MAX_BITS) || ((left & (left - 1U)) != 0U)) {
+		return -EIO;
+	}
+	ws->weights[n++] = (uint8_t)(highbit32(left) + 1U);
+
+	/*
+	 * The longest codes take the first entries of the table and, for a
+	 * given length, the symbols come in increasing order.
+	 */
+	for (s = 0U; s < n; s++) {
+		if (ws->weights[s] != 0U) {
+			rank_count[max_bits + 1U - ws->weights[s]]++;
+		}
+	}
+
+	rank_idx[max_bits] = 0U;
+	for (nbits = max_bits; nbits > 1U; nbits--) {
+		rank_idx[nbits - 1U] = rank_idx[nbits] +
+				       (rank_count[nbits] << (max_bits - nbits));
+	}
+
+	for (s = 0U; s < n; s++) {
+		if (ws->weights[s] == 0U) {
+			continue;
+		}
+		nbits = max_bits + 1U - ws->weights[s];
+		count = 1U << (max_bits - nbits);
+		for (i = 0U; i < count; i++) {
+			ws->huf[rank_idx[nbits] + i].symbol = (uint8_t)s;
+			ws->huf[rank_idx[nbits] + i].bits = (uint8_t)nbits;
+		}
+		rank_idx[nbits] += count;
+	}
+
+	ws->huf_bits = max_bits;
+
+	return 0;
+}
+
+/* Decode 'n' literals from the Huffman coded stream of 'len' bytes */
+static int huf_decode_stream(const struct zstd_ws *ws, const uint8_t *src,
+			     size_t len, uint8_t *out, size_t n)
+{
+	const struct huf_entry *e;
+	struct zstd_bits b;
+
+	if (bits_init(&b, src, len) != 0) {
+		return -EIO;
+	}
+
+	while (n-- != 0U) {
+		e = &ws->huf[bits_peek(&b, ws->huf_bits)];
+		*out++ = e->symbol;
+		b.pos -= e->bits;
+	}
+
+	/* All the bits of the stream must be used */
+	return (b.pos == 0) ? 0 : -EIO;
+}
+
+static int huf_decode_literals(struct zstd_ws *ws, const uint8_t *src,
+			       size_t len, size_t regen, bool four_streams)
+{
+	size_t sizes[4], segment;
+	unsigned int i;
+
+	if (!four_streams) {
+		return huf_decode_stream(ws, src, len, ws->lit, regen);
+	}
+
+	/* Jump table with the sizes of the first three streams */
+	if (len < 6U) {
+		return -EIO;
+	}
+	sizes[0] = (size_t)src[0] | ((size_t)src[1] << 8);
+	sizes[1] = (size_t)src[2] | ((size_t)src[3] << 8);
+	sizes[2] = (size_t)src[4] | ((size_t)src[5] << 8);
+	src += 6;
+	len -= 6U;
+	if ((sizes[0] + sizes[1] + sizes[2]) > len) {
+		return -EIO;
+	}
+	sizes[3] = len - sizes[0] - sizes[1] - sizes[2];
+
+	/* The first three streams hold a quarter of the literals each */
+	segment = (regen + 3U) / 4U;
+	if ((3U * segment) > regen) {
+		return -EIO;
+	}
+
+	for (i = 0U; i < 4U; i++) {
+		if (huf_decode_stream(ws, src, sizes[i],
+				      ws->lit + (i * segment),
+				      (i < 3U) ? segment :
+						 (regen - (3U * segment))) != 0) {
+			return -EIO;
+		}
+		src += sizes[i];
+	}
+
+	return 0;
+}
+
+/*
+ * Decode the literals section at 'src'. The literals are left in the input
+ * when they are stored raw, and in ws->lit otherwise.
+ */
+static int zstd_decode_literals(struct zstd_ws *ws, const uint8_t *src,
+				size_t len, const uint8_t **lit,
+				size_t *lit_len, size_t *used)
+{
+	unsigned int type, format, size_bits;
+	size_t hdr_len, regen, comp, table_len = 0U;
+	uint64_t hdr;
+
+	if (len == 0U) {
+		return -EIO;
+	}
+
+	type = src[0] & 0x3U;
+	format = (src[0] >> 2) & 0x3U;
+
+	if ((type == ZSTD_LIT_RAW) || (type == ZSTD_LIT_RLE)) {
+		hdr_len = ((format & 1U) == 0U) ? 1U : (format == 1U) ? 2U : 3U;
+		if (len < hdr_len) {
+			return -EIO;
+		}
+		hdr = load_le(src, hdr_len);
+		regen = (hdr_len == 1U) ? (size_t)(hdr >> 3) :
+					  (size_t)(hdr >> 4);
+		if (regen > ZSTD_BLOCK_MAX) {
+			return -EIO;
+		}
+
+		if (type == ZSTD_LIT_RAW) {
+			if ((len - hdr_len) < regen) {
+				return -EIO;
+			}
+			*lit = src + hdr_len;
+			*used = hdr_len + regen;
+		} else {
+			if ((len - hdr_len) < 1U) {
+				return -EIO;
+			}
+			(void)memset(ws->lit, src[hdr_len], regen);
+			*lit = ws->lit;
+			*used = hdr_len + 1U;
+		}
+		*lit_len = regen;
+
+		return 0;
+	}
+
+	/* Huffman coded literals, in one or four streams */
+	hdr_len = (format < 2U) ? 3U : (format + 2U);
+	size_bits = (format < 2U) ? 10U : (format == 2U) ? 14U : 18U;
+	if (len < hdr_len) {
+		return -EIO;
+	}
+	hdr = load_le(src, hdr_len);
+	regen = (size_t)(hdr >> 4) & ((1U << size_bits) - 1U);
+	comp = (size_t)(hdr >> (4U + size_bits)) & ((1U << size_bits) - 1U);
+	if ((regen > ZSTD_BLOCK_MAX) || (comp > (len - hdr_len))) {
+		return -EIO;
+	}
+	src += hdr_len;
+
+	if (type == ZSTD_LIT_COMPRESSED) {
+		if (huf_read_table(ws, src, comp, &table_len) != 0) {
+			return -EIO;
+		}
+	} else if (ws->huf_bits == 0U) {
+		/* Treeless literals reuse the table of a previous block */
+		return -EIO;
+	}
+
+	if (huf_decode_literals(ws, src + table_len, comp - table_len, regen,
+				format != 0U) != 0) {
+		return -EIO;
+	}
+
+	*lit = ws->lit;
+	*lit_len = regen;
+	*used = hdr_len + comp;
+
+	return 0;
+}
+
+/* Set up the FSE table of a kind of sequence code for the given mode */
+static int zstd_read_seq_table(struct fse_table *t,
+			       const struct zstd_seq_code *code,
+			       unsigned int mode, const uint8_t *src,
+			       size_t len, size_t *used)
+{
+	int16_t counts[FSE_MAX_SYMBOLS];
+
+	*used = 0U;
+
+	switch (mode) {
+	case ZSTD_MODE_PREDEFINED:
+		t->log = code->def_log;
+		if (fse_build(t->entries, code->def, code->def_symbols,
+			      t->log) != 0) {
+			return -EIO;
+		}
+		break;
+	case ZSTD_MODE_RLE:
+		if ((len == 0U) || (src[0] >= code->max_symbols)) {
+			return -EIO;
+		}
+		t->log = 0U;
+		t->entries[0].symbol = src[0];
+		t->entries[0].bits = 0U;
+		t->entries[0].baseline = 0U;
+		*used = 1U;
+		break;
+	case ZSTD_MODE_FSE:
+		if ((fse_read_counts(src, len, counts, code->max_symbols,
+				     code->max_log, &t->log, used) != 0) ||
+		    (fse_build(t->entries, counts, code->max_symbols,
+			       t->log) != 0)) {
+			return -EIO;
+		}
+		break;
+	default:
+		/* Repeat the table of the previous block */
+		if (!t->valid) {
+			return -EIO;
+		}
+		break;
+	}
+
+	t->valid = true;
+
+	return 0;
+}
+
+/* Resolve the offset value of a sequence, updating the repeated offsets */
+static inline uint32_t zstd_offset(uint32_t *rep, uint32_t value, size_t ll)
+{
+	uint32_t offset;
+	unsigned int idx;
+
+	if (value > 3U) {
+		offset = value - 3U;
+	} else {
+		/* Without literals, the repeated offsets are shifted by one */
+		idx = (unsigned int)value - ((ll != 0U) ? 1U : 0U);
+		if (idx == 0U) {
+			return rep[0];
+		}
+		offset = (idx < 3U) ? rep[idx] : (rep[0] - 1U);
+		if (idx == 1U) {
+			rep[1] = rep[0];
+			rep[0] = offset;
+			return offset;
+		}
+	}
+
+	rep[2] = rep[1];
+	rep[1] = rep[0];
+	rep[0] = offset;
+
+	return offset;
+}
+
+/*
+ * Decode the sequences section at 'src' and execute the sequences, taking
+ * the literals from 'lit'. Matches may refer to any earlier output of the
+ * frame, from 'ostart' on.
+ */
+static int zstd_decode_sequences(struct zstd_ws *ws, const uint8_t *src,
+				 size_t len, const uint8_t *lit,
+				 size_t lit_len, uint8_t *ostart,
+				 uint8_t **op_ptr, uint8_t *oend)
+{
+	const uint8_t *ip = src;
+	const uint8_t *iend = src + len;
+	const uint8_t *lit_end = lit + lit_len;
+	const struct fse_entry *lle, *ofe, *mle;
+	uint8_t *op = *op_ptr;
+	const uint8_t *match;
+	struct zstd_bits b;
+	uint32_t nseq, i, ll_state, of_state, ml_state, offset;
+	unsigned int modes;
+	size_t ll, ml, used;
+
+	if (ip == iend) {
+		return -EIO;
+	}
+
+	nseq = *ip++;
+	if (nseq == 255U) {
+		if ((iend - ip) < 2) {
+			return -EIO;
+		}
+		nseq = (uint32_t)ip[0] + ((uint32_t)ip[1] << 8) + 0x7F00U;
+		ip += 2;
+	} else if (nseq >= 128U) {
+		if (ip == iend) {
+			return -EIO;
+		}
+		nseq = ((nseq - 128U) << 8) + *ip++;
+	}
+
+	if (nseq != 0U) {
+		if (ip == iend) {
+			return -EIO;
+		}
+		modes = *ip++;
+		if ((modes & 0x3U) != 0U) {
+			return -EIO;
+		}
+
+		/* Tables of the literal length, offset and match length codes */
+		if (zstd_read_seq_table(&ws->ll, &ll_code, modes >> 6, ip,
+					(size_t)(iend - ip), &used) != 0) {
+			return -EIO;
+		}
+		ip += used;
+		if (zstd_read_seq_table(&ws->of, &of_code, (modes >> 4) & 3U,
+					ip, (size_t)(iend - ip), &used) != 0) {
+			return -EIO;
+		}
+		ip += used;
+		if (zstd_read_seq_table(&ws->ml, &ml_code, (modes >> 2) & 3U,
+					ip, (size_t)(iend - ip), &used) != 0) {
+			return -EIO;
+		}
+		ip += used;
+
+		/* The rest of the block is the bit stream of the sequences */
+		if (bits_init(&b, ip, (size_t)(iend - ip)) != 0) {
+			return -EIO;
+		}
+		ip = iend;
+
+		ll_state = bits_read(&b, ws->ll.log);
+		of_state = bits_read(&b, ws->of.log);
+		ml_state = bits_read(&b, ws->ml.log);
+
+		for (i = 0U; i < nseq; i++) {
+			lle = &ws->ll.entries[ll_state];
+			ofe = &ws->of.entries[of_state];
+			mle = &ws->ml.entries[ml_state];
+
+			offset = (1U << ofe->symbol) +
+				 bits_read(&b, ofe->symbol);
+			ml = ml_base[mle->symbol] +
+			     bits_read(&b, ml_bits[mle->symbol]);
+			ll = ll_base[lle->symbol] +
+			     bits_read(&b, ll_bits[lle->symbol]);
+
+			if ((i + 1U) < nseq) {
+				ll_state = lle->baseline +
+					   bits_read(&b, lle->bits);
+				ml_state = mle->baseline +
+					   bits_read(&b, mle->bits);
+				of_state = ofe->baseline +
+					   bits_read(&b, ofe->bits);
+			}
+
+			if (b.pos < 0) {
+				return -EIO;
+			}
+
+			/* Literals */
+			if (((size_t)(lit_end - lit) < ll) ||
+			    ((size_t)(oend - op) < ll)) {
+				return -EIO;
+			}
+			(void)memcpy(op, lit, ll);
+			op += ll;
+			lit += ll;
+
+			/* Match */
+			offset = zstd_offset(ws->rep, offset, ll);
+			if ((offset == 0U) ||
+			    ((size_t)offset > (size_t)(op - ostart)) ||
+			    ((size_t)(oend - op) < ml)) {
+				return -EIO;
+			}
+
+			match = op - offset;
+			if (offset >= ml) {
+				(void)memcpy(op, match, ml);
+				op += ml;
+			} else {
+				/* Overlapping match, repeating the last bytes */
+				while (ml-- != 0U) {
+					*op++ = *match++;
+				}
+			}
+		}
+
+		/* All the bits of the stream must be used */
+		if (b.pos != 0) {
+			return -EIO;
+		}
+	}
+
+	if (ip != iend) {
+		return -EIO;
+	}
+
+	/* The literals left after the last sequence */
+	ll = (size_t)(lit_end - lit);
+	if ((size_t)(oend - op) < ll) {
+		return -EIO;
+	}
+	(void)memcpy(op, lit, ll);
+	op += ll;
+
+	*op_ptr = op;
+
+	return 0;
+}
+
+static int zstd_decode_block(struct zstd_ws *ws, const uint8_t *src,
+			     size_t len, uint8_t *ostart, uint8_t **op_ptr,
+			     uint8_t *oend)
+{
+	const uint8_t *lit;
+	size_t lit_len, used;
+
+	if (zstd_decode_literals(ws, src, len, &lit, &lit_len, &used) != 0) {
+		return -EIO;
+	}
+
+	return zstd_decode_sequences(ws, src + used, len - used, lit, lit_len,
+				     ostart, op_ptr, oend);
+}
+
+static int zstd_decode_frame(struct zstd_in *in, struct zstd_ws *ws,
+			     uint8_t **op_ptr, uint8_t *oend)
+{
+	static const uint8_t dict_id_len[] = { 0U, 1U, 2U, 4U };
+	static const uint8_t fcs_len[] = { 0U, 2U, 4U, 8U };
+	const uint8_t *data;
+	uint8_t *op = *op_ptr;
+	uint8_t *frame_start = op;
+	uint64_t content_size = 0U;
+	uint32_t fhd, hdr, type, size;
+	size_t len;
+	int ret;
+
+	/* Frame header */
+	ret = zstd_get(in, &data, 1U);
+	if (ret != 0) {
+		return ret;
+	}
+
+	fhd = *data;
+	if ((fhd & ZSTD_FHD_RESERVED) != 0U) {
+		ERROR("zstd: unsupported frame header\n");
+		return -EIO;
+	}
+
+	/* Window descriptor: the whole output is available anyway */
+	if ((fhd & ZSTD_FHD_SINGLE_SEGMENT) == 0U) {
+		ret = zstd_get(in, &data, 1U);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	len = dict_id_len[fhd & ZSTD_FHD_DICT_ID_MASK];
+	ret = zstd_get(in, &data, len);
+	if (ret != 0) {
+		return ret;
+	}
+	if (load_le(data, len) != 0U) {
+		ERROR("zstd: dictionaries are not supported\n");
+		return -EIO;
+	}
+
+	len = fcs_len[fhd >> ZSTD_FHD_FCS_SHIFT];
+	if ((len == 0U) && ((fhd & ZSTD_FHD_SINGLE_SEGMENT) != 0U)) {
+		len = 1U;
+	}
+	ret = zstd_get(in, &data, len);
+	if (ret != 0) {
+		return ret;
+	}
+	content_size = load_le(data, len);
+	if (len == 2U) {
+		content_size += 256U;
+	}
+
+	if (content_size > (uint64_t)(oend - op)) {
+		ERROR("zstd: output buffer too small\n");
+		return -ENOMEM;
+	}
+
+	/* The tables and repeated offsets are reset for each frame */
+	ws->ll.valid = false;
+	ws->of.valid = false;
+	ws->ml.valid = false;
+	ws->huf_bits = 0U;
+	ws->rep[0] = 1U;
+	ws->rep[1] = 4U;
+	ws->rep[2] = 8U;
+
+	/* Blocks, up to the last one */
+	do {
+		ret = zstd_get(in, &data, 3U);
+		if (ret != 0) {
+			return ret;
+		}
+
+		hdr = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+		      ((uint32_t)data[2] << 16);
+		type = (hdr >> ZSTD_BLOCK_TYPE_SHIFT) & ZSTD_BLOCK_TYPE_MASK;
+		size = hdr >> ZSTD_BLOCK_SIZE_SHIFT;
+		if (size > ZSTD_BLOCK_MAX) {
+			ERROR("zstd: corrupted block\n");
+			return -EIO;
+		}
+
+		ret = zstd_get(in, &data, (type == ZSTD_BLOCK_RLE) ? 1U : size);
+		if (ret != 0) {
+			return ret;
+		}
+
+		if ((type == ZSTD_BLOCK_RAW) || (type == ZSTD_BLOCK_RLE)) {
+			if ((size_t)(oend - op) < size) {
+				ERROR("zstd: output buffer too small\n");
+				return -ENOMEM;
+			}
+			if (type == ZSTD_BLOCK_RAW) {
+				(void)memcpy(op, data, size);
+			} else {
+				(void)memset(op, *data, size);
+			}
+			op += size;
+		} else if (type == ZSTD_BLOCK_COMPRESSED) {
+			ret = zstd_decode_block(ws, data, size, frame_start,
+						&op, oend);
+			if (ret != 0) {
+				ERROR("zstd: corrupted block\n");
+				return ret;
+			}
+		} else {
+			ERROR("zstd: unsupported block type\n");
+			return -EIO;
+		}
+	} while ((hdr & ZSTD_BLOCK_LAST) == 0U);
+
+	if ((len != 0U) && (content_size != (uint64_t)(op - frame_start))) {
+		ERROR("zstd: bad content size\n");
+		return -EIO;
+	}
+
+	if ((fhd & ZSTD_FHD_CHECKSUM) != 0U) {
+		ret = zstd_get(in, &data, 4U);
+		if (ret != 0) {
+			return ret;
+		}
+		if (get_le32(data) !=
+		    (uint32_t)xxh64(frame_start, (size_t)(op - frame_start))) {
+			ERROR("zstd: bad content checksum\n");
+			return -EIO;
+		}
+	}
+
+	*op_ptr = op;
+
+	return 0;
+}
+
+/*
+ * unzstd - decompress Zstandard frames
+ * @in_buf: source of compressed input. Upon exit, the end of input.
+ * @in_len: length of in_buf
+ * @out_buf: destination of decompressed output. Upon exit, the end of output.
+ * @out_len: length of out_buf
+ * @work_buf: workspace, holding the decoding tables and literals
+ * @work_len: length of workspace
+ *
+ * Consecutive frames are decompressed one after the other and skippable
+ * frames are ignored. The decoding stops at the end of the input or at the
+ * first data that is not a frame, such as padding.
+ */
+int unzstd(uintptr_t *in_buf, size_t in_len, uintptr_t *out_buf,
+	   size_t out_len, uintptr_t work_buf, size_t work_len)
+{
+	uintptr_t ws_base = round_up(work_buf, sizeof(uint64_t));
+	struct zstd_ws *ws = (struct zstd_ws *)ws_base;
+	struct zstd_in in;
+	uint8_t *ostart = (uint8_t *)*out_buf;
+	uint8_t *op = ostart;
+	const uint8_t *data;
+	uint32_t magic;
+	bool found = false;
+	int ret = 0;
+
+	if (work_len < ((ws_base - work_buf) + sizeof(*ws))) {
+		ERROR("zstd: workspace too small (%lu bytes needed)\n",
+		      (unsigned long)sizeof(*ws));
+		return -ENOMEM;
+	}
+
+	in.pos = (const uint8_t *)*in_buf;
+	in.end = in.pos + in_len;
+
+	while ((size_t)(in.end - in.pos) >= 4U) {
+		magic = get_le32(in.pos);
+
+		if ((magic & ZSTD_SKIPPABLE_MASK) == ZSTD_SKIPPABLE_MAGIC) {
+			in.pos += 4;
+			ret = zstd_get(&in, &data, 4U);
+			if (ret == 0) {
+				ret = zstd_get(&in, &data, get_le32(data));
+			}
+		} else if (magic == ZSTD_FRAME_MAGIC) {
+			in.pos += 4;
+			ret = zstd_decode_frame(&in, ws, &op, ostart + out_len);
+			found = true;
+		} else {
+			break;
+		}
+
+		if (ret != 0) {
+			break;
+		}
+	}
+
+	if ((ret == 0) && !found) {
+		ERROR("zstd: no frame found\n");
+		ret = -EIO;
+	}
+
+	VERBOSE("zstd: %lu byte input\n",
+		(unsigned long)((uintptr_t)in.pos - *in_buf));
+	VERBOSE("zstd: %lu byte output\n", (unsigned long)(op - ostart));
+
+	*in_buf = (uintptr_t)in.pos;
+	*out_buf = (uintptr_t)op;
+
+	return ret;
+}
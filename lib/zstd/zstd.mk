@@ -0,0 +1,12 @@
+#
+# Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+ZSTD_PATH	:=	lib/zstd
+
+ZSTD_SOURCES	:=	$(addprefix $(ZSTD_PATH)/,	\
+					tf_unzstd.c)
+
+INCLUDES	+=	-Iinclude/lib/zstd
@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+# Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -251,6 +251,24 @@ endef
 
 GZIP_SUFFIX := .gz
 
+# LZ4
+define LZ4_RULE
+$(1): $(2)
+	$(ECHO) "  LZ4     $$@"
+	$(Q)lz4 -9 -f -q $$< $$@
+endef
+
+LZ4_SUFFIX := .lz4
+
+# ZSTD
+define ZSTD_RULE
+$(1): $(2)
+	$(ECHO) "  ZSTD    $$@"
+	$(Q)zstd -19 -f -q $$< -o $$@
+endef
+
+ZSTD_SUFFIX := .zst
+
 ################################################################################
 # Auxiliary macros to build TF images from sources
 ################################################################################
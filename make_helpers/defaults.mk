@@ -29,6 +29,9 @@ ARM_ARCH_MINOR			:= 0
 # Base commit to perform code check on
 BASE_COMMIT			:= origin/master
 
+# Use the compact variants of the assembly memcpy() and memmove() in BL1
+BL1_SMALL_LIBC			:= 0
+
 # Execute BL2 at EL3
 BL2_AT_EL3			:= 0
 
@@ -70,6 +73,14 @@ CTX_INCLUDE_PAUTH_REGS		:= 0
 # Extension and platform wants to use this feature in the Secure world
 CTX_INCLUDE_NEVE_REGS		:= 0
 
+# Skip saving and restoring groups of lower EL system registers that already
+# hold the values of the context being restored or that the world does not use
+CTX_LAZY_SYSREGS		:= 0
+
+# Measure the cost of saving and restoring each group of lower EL system
+# registers at boot. Requires CTX_LAZY_SYSREGS and DEBUG.
+CTX_SYSREGS_BENCHMARK		:= 0
+
 # Debug build
 DEBUG				:= 0
 
@@ -102,12 +113,19 @@ ENABLE_PMF			:= 0
 # Flag to enable PSCI STATs functionality
 ENABLE_PSCI_STAT		:= 0
 
+# Flag to enable per-CPU latency histograms of the runtime services
+ENABLE_RT_SVC_HISTOGRAMS	:= 0
+
 # Flag to enable runtime instrumentation using PMF
 ENABLE_RUNTIME_INSTRUMENTATION	:= 0
 
 # Flag to enable stack corruption protection
 ENABLE_STACK_PROTECTOR		:= 0
 
+# Flag to record the priority activations, deactivations and preemptions of
+# the EL3 Exception Handling Framework in a per-CPU trace buffer
+EHF_TRACE			:= 0
+
 # Flag to enable exception handling in EL3
 EL3_EXCEPTION_HANDLING		:= 0
 
@@ -170,6 +188,9 @@ HASH_ALG			:= sha256
 # operations.
 HW_ASSISTED_COHERENCY		:= 0
 
+# Decompress images while they are loaded rather than after loading them
+IMAGE_DECOMPRESS_STREAM		:= 0
+
 # Set the default algorithm for the generation of Trusted Board Boot keys
 KEY_ALG				:= rsa
 
@@ -187,6 +208,9 @@ NS_TIMER_SWITCH			:= 0
 # Include lib/libc in the final image
 OVERRIDE_LIBC			:= 0
 
+# Let the CPU_ON requests of CPUs sharing a power domain complete concurrently
+PARALLEL_CPU_ON			:= 0
+
 # Build PL011 UART driver in minimal generic UART mode
 PL011_GENERIC_UART		:= 0
 
@@ -197,6 +221,12 @@ PROGRAMMABLE_RESET_ADDRESS	:= 0
 # Flag used to choose the power state format: Extended State-ID or Original
 PSCI_EXTENDED_STATE_ID		:= 0
 
+# Use queued locks for PSCI power domain state coordination
+PSCI_QUEUED_LOCKS		:= 0
+
+# Enable the PMF call that copies all the PSCI statistics to a normal world buffer
+PSCI_STAT_SNAPSHOT		:= 0
+
 # Enable RAS support
 RAS_EXTENSION			:= 0
 
@@ -230,6 +260,12 @@ SPD				:= none
 # Enable the Management Mode (MM)-based Secure Partition Manager implementation
 SPM_MM				:= 0
 
+# Also forward x8-x17 in SMC64 FF-A direct messages relayed by the SPMD
+SPMD_DIRECT_MSG_EXT_REGS	:= 0
+
+# Forward FF-A direct messages before the generic SPMD dispatch
+SPMD_DIRECT_MSG_FAST_PATH	:= 0
+
 # Use SPM at S-EL2 as a default config for SPMD
 SPMD_SPM_AT_SEL2		:= 1
 
@@ -237,12 +273,21 @@ SPMD_SPM_AT_SEL2		:= 1
 # image. This is meant to help debugging the post-BL2 phase.
 SPIN_ON_BL1_EXIT		:= 0
 
+# Flag to decrypt encrypted images in place while they are being read
+STREAM_DECRYPTION		:= 0
+
+# Hash images authenticated by hash while they are being loaded
+STREAM_HASH_AUTH		:= 0
+
 # Flags to build TF with Trusted Boot support
 TRUSTED_BOARD_BOOT		:= 0
 
 # Build option to choose whether Trusted Firmware uses Coherent memory or not.
 USE_COHERENT_MEM		:= 1
 
+# Use DC ZVA in the assembly memset() for large zero fills
+USE_DCZVA_MEMSET		:= 0
+
 # Build option to add debugfs support
 USE_DEBUGFS			:= 0
 
@@ -280,6 +325,9 @@ V				:= 0
 # platforms).
 WARMBOOT_ENABLE_DCACHE_EARLY	:= 0
 
+# Run a benchmark of the memory zeroing routines during BL31 cold boot
+ZERO_MEM_BENCHMARK		:= 0
+
 # Build option to enable/disable the Statistical Profiling Extensions
 ENABLE_SPE_FOR_LOWER_ELS	:= 1
 
@@ -312,6 +360,14 @@ SANITIZE_UB := off
 # Default: disabled
 USE_SPINLOCK_CAS := 0
 
+# Enabling this option selects a fair ticket lock implementation for spinlocks.
+# Default: disabled
+USE_TICKET_SPINLOCK := 0
+
+# Keep per-lock contention statistics for ticket spinlocks.
+# Default: disabled
+SPINLOCK_STATS := 0
+
 # Enable Link Time Optimization
 ENABLE_LTO			:= 0
 
@@ -136,6 +136,15 @@ void plat_arm_gic_driver_init(void)
 #if (!defined(__aarch64__) && defined(IMAGE_BL32)) || \
 	(defined(__aarch64__) && defined(IMAGE_BL31))
 	gicv3_driver_init(&fvp_gic_data);
+
+#if PARALLEL_CPU_ON
+	/* Find the Redistributor frames of all the CPUs at once */
+	for (const uint64_t *frames = fvp_gicr_frames; *frames != 0U;
+	     frames++) {
+		gicv3_rdistif_probe_all((uintptr_t)*frames);
+	}
+#endif
+
 	if (gicv3_rdistif_probe((uintptr_t)fvp_gicr_base_addrs[0]) == -1) {
 		ERROR("No GICR base frame found for Primary CPU\n");
 		panic();
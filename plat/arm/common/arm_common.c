@@ -1,10 +1,11 @@
 /*
- * Copyright (c) 2015-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
+#include <stdbool.h>
 
 #include <platform_def.h>
 
@@ -237,3 +238,32 @@ int plat_sdei_validate_entry_point(uintptr_t ep, unsigned int client_mode)
 }
 #endif
 
+#if ENABLE_RT_SVC_HISTOGRAMS || PSCI_STAT_SNAPSHOT
+/* Check that [base, base + size) lies within a single region */
+static bool arm_is_in_region(unsigned long long base, size_t size,
+			     unsigned long long region_base,
+			     unsigned long long region_size)
+{
+	return (base >= region_base) && (size <= region_size) &&
+	       ((base - region_base) <= (region_size - size));
+}
+
+/*******************************************************************************
+ * Check that a buffer supplied by the normal world lies within the non-secure
+ * DRAM, so that EL3 can safely write to it.
+ ******************************************************************************/
+bool plat_is_ns_buffer(unsigned long long base, size_t size)
+{
+	if (arm_is_in_region(base, size, ARM_NS_DRAM1_BASE,
+			     ARM_NS_DRAM1_SIZE)) {
+		return true;
+	}
+#ifdef __aarch64__
+	if (arm_is_in_region(base, size, ARM_DRAM2_BASE, ARM_DRAM2_SIZE)) {
+		return true;
+	}
+#endif
+
+	return false;
+}
+#endif /* ENABLE_RT_SVC_HISTOGRAMS || PSCI_STAT_SNAPSHOT */
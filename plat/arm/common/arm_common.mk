@@ -186,6 +186,15 @@ PLAT_BL_COMMON_SOURCES	+=	plat/arm/common/${ARCH}/arm_helpers.S		\
 				plat/arm/common/arm_common.c			\
 				plat/arm/common/arm_console.c
 
+# The PMF calls that copy data to a normal world buffer map it dynamically
+ifneq ($(filter 1,${ENABLE_RT_SVC_HISTOGRAMS} ${PSCI_STAT_SNAPSHOT}),)
+    ifeq (${ARCH},aarch32)
+        BL32_CPPFLAGS	+=	-DPLAT_XLAT_TABLES_DYNAMIC
+    else
+        BL31_CPPFLAGS	+=	-DPLAT_XLAT_TABLES_DYNAMIC
+    endif
+endif
+
 ifeq (${ARM_XLAT_TABLES_LIB_V1}, 1)
 PLAT_BL_COMMON_SOURCES	+=	lib/xlat_tables/xlat_tables_common.c		\
 				lib/xlat_tables/${ARCH}/xlat_tables.c
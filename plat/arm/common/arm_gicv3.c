@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -108,6 +108,13 @@ void __init plat_arm_gic_driver_init(void)
 	(defined(__aarch64__) && defined(IMAGE_BL31))
 	gicv3_driver_init(&arm_gic_data);
 
+#if PARALLEL_CPU_ON
+	/* Find the Redistributor frames of all the CPUs at once */
+	for (const uintptr_t *frames = gicr_frames; *frames != 0U; frames++) {
+		gicv3_rdistif_probe_all(*frames);
+	}
+#endif
+
 	if (gicv3_rdistif_probe(gicr_base_addrs[0]) == -1) {
 		ERROR("No GICR base frame found for Primary CPU\n");
 		panic();
@@ -11,6 +11,7 @@
 #include <drivers/arm/ethosn.h>
 #include <lib/debugfs.h>
 #include <lib/pmf/pmf.h>
+#include <lib/spinlock.h>
 #include <plat/arm/common/arm_sip_svc.h>
 #include <plat/arm/common/plat_arm.h>
 #include <tools_share/uuid.h>
@@ -73,6 +74,15 @@ static uintptr_t arm_sip_handler(unsigned int smc_fid,
 
 #endif /* USE_DEBUGFS */
 
+#if SPINLOCK_STATS
+
+	if (is_spinlock_stats_fid(smc_fid)) {
+		return spinlock_stats_smc_handler(smc_fid, x1, x2, x3, x4,
+						  cookie, handle, flags);
+	}
+
+#endif /* SPINLOCK_STATS */
+
 #if ARM_ETHOSN_NPU_DRIVER
 
 	if (is_ethosn_fid(smc_fid)) {
@@ -111,6 +121,11 @@ static uintptr_t arm_sip_handler(unsigned int smc_fid,
 		call_count += ETHOSN_NUM_SMC_CALLS;
 #endif /* ARM_ETHOSN_NPU_DRIVER */
 
+#if SPINLOCK_STATS
+		/* Spinlock statistics call */
+		call_count += SPINLOCK_STATS_NUM_SMC_CALLS;
+#endif /* SPINLOCK_STATS */
+
 		/* State switch call */
 		call_count += 1;
 
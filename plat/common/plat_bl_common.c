@@ -29,6 +29,9 @@
 #pragma weak plat_is_smccc_feature_available
 #pragma weak plat_get_soc_version
 #pragma weak plat_get_soc_revision
+#if ENABLE_RT_SVC_HISTOGRAMS || PSCI_STAT_SNAPSHOT
+#pragma weak plat_is_ns_buffer
+#endif
 
 int32_t plat_get_soc_version(void)
 {
@@ -74,6 +77,17 @@ int plat_try_next_boot_source(void)
 	return 0;
 }
 
+#if ENABLE_RT_SVC_HISTOGRAMS || PSCI_STAT_SNAPSHOT
+/*
+ * Weak implementation that accepts no normal world buffer, so the PMF calls
+ * that copy data to one fail until the platform describes its memory.
+ */
+bool plat_is_ns_buffer(unsigned long long base, size_t size)
+{
+	return false;
+}
+#endif
+
 /*
  * Weak implementation to provide dummy decryption key only for test purposes,
  * platforms must override this API for any real world firmware encryption
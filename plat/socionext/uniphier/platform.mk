@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2017-2020, ARM Limited and Contributors. All rights reserved.
+# Copyright (c) 2017-2021, ARM Limited and Contributors. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -133,6 +133,56 @@ BL33_PRE_TOOL_FILTER	:= GZIP
 
 endif
 
+ifeq (${FIP_LZ4},1)
+
+ifeq (${FIP_GZIP},1)
+$(error FIP_GZIP and FIP_LZ4 cannot be used together)
+endif
+
+ifeq (${IMAGE_DECOMPRESS_STREAM},1)
+$(error IMAGE_DECOMPRESS_STREAM is not supported with FIP_LZ4)
+endif
+
+include lib/lz4/lz4.mk
+
+BL2_SOURCES		+=	common/image_decompress.c		\
+				$(LZ4_SOURCES)
+
+$(eval $(call add_define,UNIPHIER_DECOMPRESS_LZ4))
+
+# compress all images loaded by BL2
+SCP_BL2_PRE_TOOL_FILTER	:= LZ4
+BL31_PRE_TOOL_FILTER	:= LZ4
+BL32_PRE_TOOL_FILTER	:= LZ4
+BL33_PRE_TOOL_FILTER	:= LZ4
+
+endif
+
+ifeq (${FIP_ZSTD},1)
+
+ifneq ($(filter 1,${FIP_GZIP} ${FIP_LZ4}),)
+$(error FIP_ZSTD cannot be used together with FIP_GZIP or FIP_LZ4)
+endif
+
+ifeq (${IMAGE_DECOMPRESS_STREAM},1)
+$(error IMAGE_DECOMPRESS_STREAM is not supported with FIP_ZSTD)
+endif
+
+include lib/zstd/zstd.mk
+
+BL2_SOURCES		+=	common/image_decompress.c		\
+				$(ZSTD_SOURCES)
+
+$(eval $(call add_define,UNIPHIER_DECOMPRESS_ZSTD))
+
+# compress all images loaded by BL2
+SCP_BL2_PRE_TOOL_FILTER	:= ZSTD
+BL31_PRE_TOOL_FILTER	:= ZSTD
+BL32_PRE_TOOL_FILTER	:= ZSTD
+BL33_PRE_TOOL_FILTER	:= ZSTD
+
+endif
+
 .PHONY: bl2_gzip
 bl2_gzip: $(BUILD_PLAT)/bl2.bin.gz
 %.gz: %
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -18,12 +18,37 @@
 #ifdef UNIPHIER_DECOMPRESS_GZIP
 #include <tf_gunzip.h>
 #endif
+#ifdef UNIPHIER_DECOMPRESS_LZ4
+#include <tf_unlz4.h>
+#endif
+#ifdef UNIPHIER_DECOMPRESS_ZSTD
+#include <tf_unzstd.h>
+#endif
 
 #include "uniphier.h"
 
 #define UNIPHIER_IMAGE_BUF_OFFSET	0x03800000UL
 #define UNIPHIER_IMAGE_BUF_SIZE		0x00800000UL
 
+#if defined(UNIPHIER_DECOMPRESS_GZIP)
+#define UNIPHIER_DECOMPRESS
+#define UNIPHIER_DECOMPRESSOR		gunzip
+#elif defined(UNIPHIER_DECOMPRESS_LZ4)
+#define UNIPHIER_DECOMPRESS
+#define UNIPHIER_DECOMPRESSOR		unlz4
+#elif defined(UNIPHIER_DECOMPRESS_ZSTD)
+#define UNIPHIER_DECOMPRESS
+#define UNIPHIER_DECOMPRESSOR		unzstd
+#endif
+
+#if defined(UNIPHIER_DECOMPRESS_GZIP) && IMAGE_DECOMPRESS_STREAM
+static const decompressor_stream_t uniphier_gunzip_stream = {
+	.init = gunzip_stream_init,
+	.update = gunzip_stream_update,
+	.finish = gunzip_stream_finish,
+};
+#endif
+
 static uintptr_t uniphier_mem_base = UNIPHIER_MEM_BASE;
 static unsigned int uniphier_soc = UNIPHIER_SOC_UNKNOWN;
 static int uniphier_bl2_kick_scp;
@@ -110,7 +135,7 @@ bl_params_t *plat_get_next_bl_params(void)
 
 void bl2_plat_preload_setup(void)
 {
-#ifdef UNIPHIER_DECOMPRESS_GZIP
+#ifdef UNIPHIER_DECOMPRESS
 	uintptr_t buf_base = uniphier_mem_base + UNIPHIER_IMAGE_BUF_OFFSET;
 	int ret;
 
@@ -120,7 +145,13 @@ void bl2_plat_preload_setup(void)
 	if (ret)
 		plat_error_handler(ret);
 
-	image_decompress_init(buf_base, UNIPHIER_IMAGE_BUF_SIZE, gunzip);
+#if IMAGE_DECOMPRESS_STREAM
+	image_decompress_stream_init(buf_base, UNIPHIER_IMAGE_BUF_SIZE,
+				     &uniphier_gunzip_stream);
+#else
+	image_decompress_init(buf_base, UNIPHIER_IMAGE_BUF_SIZE,
+			      UNIPHIER_DECOMPRESSOR);
+#endif
 #endif
 
 	uniphier_init_image_descs(uniphier_mem_base);
@@ -140,8 +171,12 @@ int bl2_plat_handle_pre_image_load(unsigned int image_id)
 	if (ret)
 		return ret;
 
-#ifdef UNIPHIER_DECOMPRESS_GZIP
+#ifdef UNIPHIER_DECOMPRESS
+#if IMAGE_DECOMPRESS_STREAM
+	image_decompress_prepare_stream(image_id, image_info);
+#else
 	image_decompress_prepare(image_info);
+#endif
 #endif
 	return 0;
 }
@@ -149,7 +184,7 @@ int bl2_plat_handle_pre_image_load(unsigned int image_id)
 int bl2_plat_handle_post_image_load(unsigned int image_id)
 {
 	struct image_info *image_info = uniphier_get_image_info(image_id);
-#ifdef UNIPHIER_DECOMPRESS_GZIP
+#ifdef UNIPHIER_DECOMPRESS
 	int ret;
 
 	if (!(image_info->h.attr & IMAGE_ATTRIB_SKIP_LOADING)) {
@@ -282,6 +282,14 @@ static int32_t tspd_setup(void)
 				tsp_ep_info->pc,
 				&tspd_sp_context[linear_id]);
 
+#if CTX_LAZY_SYSREGS
+	/*
+	 * The TSP only uses the secure physical timer, so the Non-secure
+	 * timer registers can keep the values of the normal world.
+	 */
+	cm_sysregs_set_unused(SECURE, CM_SYSREGS_BIT(CM_SYSREGS_TIMER));
+#endif
+
 #if TSP_INIT_ASYNC
 	bl31_set_next_image_type(SECURE);
 #else
@@ -1,17 +1,35 @@
 /*
- * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <assert.h>
 
+#include <drivers/arm/gic_common.h>
 #include <lib/utils.h>
 
 #include "sdei_private.h"
 
 #define MAP_OFF(_map, _mapping) ((_map) - (_mapping)->map)
 
+/*
+ * Index of the mappings bound to the interrupts below SDEI_INTR_INDEX_SIZE,
+ * which covers SGIs, PPIs and SPIs. An entry holds the offset of the mapping
+ * plus one, with SDEI_INTR_INDEX_SHARED set for shared mappings, or 0 if no
+ * mapping is bound to the interrupt. Free dynamic mappings, whose interrupt is
+ * SDEI_DYN_IRQ, and interrupts outside of the index are looked up linearly.
+ */
+#define SDEI_INTR_INDEX_SIZE	(MAX_SPI_ID + 1U)
+#define SDEI_INTR_INDEX_SHARED	U(0x8000)
+
+static uint16_t sdei_intr_index[SDEI_INTR_INDEX_SIZE];
+
+static inline bool is_intr_indexed(unsigned int intr_num)
+{
+	return (intr_num != SDEI_DYN_IRQ) && (intr_num < SDEI_INTR_INDEX_SIZE);
+}
+
 /*
  * Get SDEI entry with the given mapping: on success, returns pointer to SDEI
  * entry. On error, returns NULL.
@@ -59,14 +77,26 @@ sdei_ev_map_t *find_event_map_by_intr(unsigned int intr_num, bool shared)
 {
 	const sdei_mapping_t *mapping;
 	sdei_ev_map_t *map;
-	unsigned int i;
+	unsigned int i, entry;
 
-	/*
-	 * Look for a match in private and shared mappings, as requested. This
-	 * is a linear search. However, if the mappings are required to be
-	 * sorted, for large maps, we could consider binary search.
-	 */
 	mapping = shared ? SDEI_SHARED_MAPPING() : SDEI_PRIVATE_MAPPING();
+
+	if (is_intr_indexed(intr_num)) {
+		entry = sdei_intr_index[intr_num];
+		if ((entry == 0U) ||
+		    (((entry & SDEI_INTR_INDEX_SHARED) != 0U) != shared)) {
+			return NULL;
+		}
+
+		/*
+		 * The mapping may be getting released concurrently, in which
+		 * case its interrupt no longer matches.
+		 */
+		map = &mapping->map[(entry & ~SDEI_INTR_INDEX_SHARED) - 1U];
+		return (map->intr == intr_num) ? map : NULL;
+	}
+
+	/* Look for a match in private and shared mappings, as requested */
 	iterate_mapping(mapping, i, map) {
 		if (map->intr == intr_num)
 			return map;
@@ -83,19 +113,76 @@ sdei_ev_map_t *find_event_map(int ev_num)
 {
 	const sdei_mapping_t *mapping;
 	sdei_ev_map_t *map;
-	unsigned int i, j;
+	size_t lo, hi, mid;
+	unsigned int i;
 
 	/*
-	 * Iterate through mappings to find a match. This is a linear search.
-	 * However, if the mappings are required to be sorted, for large maps,
-	 * we could consider binary search.
+	 * Mappings are required to be sorted in the increasing order of event
+	 * number, so binary search each of them.
 	 */
 	for_each_mapping_type(i, mapping) {
-		iterate_mapping(mapping, j, map) {
-			if (map->ev_num == ev_num)
+		lo = 0U;
+		hi = mapping->num_maps;
+		while (lo < hi) {
+			mid = lo + ((hi - lo) / 2U);
+			map = &mapping->map[mid];
+			if (map->ev_num == ev_num) {
 				return map;
+			} else if (map->ev_num < ev_num) {
+				lo = mid + 1U;
+			} else {
+				hi = mid;
+			}
 		}
 	}
 
 	return NULL;
 }
+
+/*
+ * Set the interrupt of a mapping and keep the interrupt index up to date. For
+ * dynamic mappings, this must be called with the mapping locked.
+ */
+void sdei_map_set_intr(sdei_ev_map_t *map, unsigned int intr_num)
+{
+	const sdei_mapping_t *mapping;
+	unsigned int entry;
+
+	if (is_event_private(map)) {
+		mapping = SDEI_PRIVATE_MAPPING();
+		entry = 0U;
+	} else {
+		mapping = SDEI_SHARED_MAPPING();
+		entry = SDEI_INTR_INDEX_SHARED;
+	}
+	entry |= (unsigned int)MAP_OFF(map, mapping) + 1U;
+	assert((entry & ~SDEI_INTR_INDEX_SHARED) < SDEI_INTR_INDEX_SHARED);
+
+	if (is_intr_indexed(map->intr) &&
+	    (sdei_intr_index[map->intr] == entry)) {
+		sdei_intr_index[map->intr] = 0U;
+	}
+
+	map->intr = intr_num;
+
+	if (is_intr_indexed(intr_num)) {
+		sdei_intr_index[intr_num] = (uint16_t)entry;
+	}
+}
+
+/* Index the interrupts of the platform-defined mappings */
+void sdei_intr_index_init(void)
+{
+	const sdei_mapping_t *mapping;
+	sdei_ev_map_t *map;
+	unsigned int i, j;
+
+	for_each_mapping_type(i, mapping) {
+		iterate_mapping(mapping, j, map) {
+			/* An interrupt can't back more than one event */
+			assert(!is_intr_indexed(map->intr) ||
+			       (sdei_intr_index[map->intr] == 0U));
+			sdei_map_set_intr(map, map->intr);
+		}
+	}
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -229,6 +229,7 @@ void sdei_init(void)
 	plat_sdei_setup();
 	sdei_class_init(SDEI_CRITICAL);
 	sdei_class_init(SDEI_NORMAL);
+	sdei_intr_index_init();
 
 	/* Register priority level handlers */
 	ehf_register_priority_handler(PLAT_SDEI_CRITICAL_PRI,
@@ -750,7 +751,7 @@ static int sdei_interrupt_bind(unsigned int intr_num)
 
 		sdei_map_lock(map);
 		if (!is_map_bound(map)) {
-			map->intr = intr_num;
+			sdei_map_set_intr(map, intr_num);
 			set_map_bound(map);
 			retry = false;
 		}
@@ -809,7 +810,7 @@ static int sdei_interrupt_release(int ev_num)
 		 * during unregister.
 		 */
 
-		map->intr = SDEI_DYN_IRQ;
+		sdei_map_set_intr(map, SDEI_DYN_IRQ);
 		clr_map_bound(map);
 	} else {
 		SDEI_LOG("Error release bound:%d cnt:%d\n", is_map_bound(map),
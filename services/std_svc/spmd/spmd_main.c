@@ -13,7 +13,10 @@
 #include <bl31/bl31.h>
 #include <common/debug.h>
 #include <common/runtime_svc.h>
+#include <lib/cassert.h>
 #include <lib/el3_runtime/context_mgmt.h>
+#include <lib/pmf/pmf.h>
+#include <lib/runtime_instr.h>
 #include <lib/smccc.h>
 #include <lib/spinlock.h>
 #include <lib/utils.h>
@@ -41,6 +44,21 @@ static spmc_manifest_attribute_t spmc_attrs;
  ******************************************************************************/
 static entry_point_info_t *spmc_ep_info;
 
+#if SPMD_DIRECT_MSG_FAST_PATH
+/*******************************************************************************
+ * Set once the SPM Core manifest has been validated against the requirements
+ * of the direct message fast path. Left clear otherwise, in which case direct
+ * messages go through the generic FF-A dispatch.
+ ******************************************************************************/
+static bool spmd_direct_msg_fast_path;
+#endif
+
+#if SPMD_DIRECT_MSG_EXT_REGS
+/* x8-x17 of direct messages are copied as one contiguous block */
+CASSERT(CTX_GPREG_X17 == (CTX_GPREG_X8 + (9U << DWORD_SHIFT)),
+	assert_spmd_gpregs_x8_x17_contiguous);
+#endif
+
 /*******************************************************************************
  * SPM Core context on CPU based on mpidr.
  ******************************************************************************/
@@ -231,6 +249,19 @@ static int spmd_spmc_init(void *pm_addr)
 	VERBOSE("%s%x.\n", "SPM Core execution state 0x",
 		spmc_attrs.exec_state);
 
+#if SPMD_DIRECT_MSG_FAST_PATH
+	/*
+	 * The fast path hands over 64-bit argument registers as they are, which
+	 * is only meaningful to an AArch64 SPM Core.
+	 */
+	if (spmc_attrs.exec_state == MODE_RW_64) {
+		spmd_direct_msg_fast_path = true;
+		INFO("SPMD: FF-A direct message fast path enabled\n");
+	} else {
+		WARN("SPMD: FF-A direct message fast path disabled for AArch32 SPM Core\n");
+	}
+#endif
+
 #if SPMD_SPM_AT_SEL2
 	/* Ensure manifest has not requested AArch32 state in S-EL2 */
 	if (spmc_attrs.exec_state == MODE_RW_32) {
@@ -332,7 +363,58 @@ int spmd_setup(void)
 }
 
 /*******************************************************************************
- * Forward SMC to the other security state
+ * Return true if the SMC function ID is one of the FF-A direct messages
+ ******************************************************************************/
+static inline bool spmd_is_direct_msg(uint32_t smc_fid)
+{
+	return ((smc_fid == FFA_MSG_SEND_DIRECT_REQ_SMC32) ||
+		(smc_fid == FFA_MSG_SEND_DIRECT_RESP_SMC32) ||
+		(smc_fid == FFA_MSG_SEND_DIRECT_REQ_SMC64) ||
+		(smc_fid == FFA_MSG_SEND_DIRECT_RESP_SMC64));
+}
+
+/*******************************************************************************
+ * Capture the runtime instrumentation timestamps delimiting the time spent in
+ * EL3 by a direct request going from the Normal world to the Secure world and
+ * by the matching direct response. The difference between the exit timestamp
+ * of the response and the entry timestamp of the request is the round-trip
+ * latency seen by the Normal world.
+ ******************************************************************************/
+static inline void spmd_direct_msg_timestamp(uint32_t smc_fid,
+					     bool secure_origin, bool entry)
+{
+#if ENABLE_RUNTIME_INSTRUMENTATION
+	if (!secure_origin && ((smc_fid == FFA_MSG_SEND_DIRECT_REQ_SMC32) ||
+			       (smc_fid == FFA_MSG_SEND_DIRECT_REQ_SMC64))) {
+		if (entry) {
+			PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
+			    RT_INSTR_ENTER_FFA_DIRECT_REQ,
+			    PMF_NO_CACHE_MAINT);
+		} else {
+			PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
+			    RT_INSTR_EXIT_FFA_DIRECT_REQ,
+			    PMF_NO_CACHE_MAINT);
+		}
+	} else if (secure_origin &&
+		   ((smc_fid == FFA_MSG_SEND_DIRECT_RESP_SMC32) ||
+		    (smc_fid == FFA_MSG_SEND_DIRECT_RESP_SMC64))) {
+		if (entry) {
+			PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
+			    RT_INSTR_ENTER_FFA_DIRECT_RESP,
+			    PMF_NO_CACHE_MAINT);
+		} else {
+			PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
+			    RT_INSTR_EXIT_FFA_DIRECT_RESP,
+			    PMF_NO_CACHE_MAINT);
+		}
+	}
+#endif
+}
+
+/*******************************************************************************
+ * Forward SMC to the other security state. x0-x7 are forwarded. x8-x17 are
+ * forwarded as well for the SMC64 direct messages when SPMD_DIRECT_MSG_EXT_REGS
+ * is set.
  ******************************************************************************/
 static uint64_t spmd_smc_forward(uint32_t smc_fid,
 				 bool secure_origin,
@@ -344,6 +426,7 @@ static uint64_t spmd_smc_forward(uint32_t smc_fid,
 {
 	unsigned int secure_state_in = (secure_origin) ? SECURE : NON_SECURE;
 	unsigned int secure_state_out = (!secure_origin) ? SECURE : NON_SECURE;
+	cpu_context_t *ctx_out;
 
 	/* Save incoming security state */
 	cm_el1_sysregs_context_save(secure_state_in);
@@ -358,7 +441,19 @@ static uint64_t spmd_smc_forward(uint32_t smc_fid,
 #endif
 	cm_set_next_eret_context(secure_state_out);
 
-	SMC_RET8(cm_get_context(secure_state_out), smc_fid, x1, x2, x3, x4,
+	ctx_out = cm_get_context(secure_state_out);
+
+#if SPMD_DIRECT_MSG_EXT_REGS
+	if (spmd_is_direct_msg(smc_fid) && (GET_SMC_CC(smc_fid) == SMC_64)) {
+		(void)memcpy((uint8_t *)get_gpregs_ctx(ctx_out) + CTX_GPREG_X8,
+			     (uint8_t *)get_gpregs_ctx(handle) + CTX_GPREG_X8,
+			     10U << DWORD_SHIFT);
+	}
+#endif
+
+	spmd_direct_msg_timestamp(smc_fid, secure_origin, false);
+
+	SMC_RET8(ctx_out, smc_fid, x1, x2, x3, x4,
 			SMC_GET_GP(handle, CTX_GPREG_X5),
 			SMC_GET_GP(handle, CTX_GPREG_X6),
 			SMC_GET_GP(handle, CTX_GPREG_X7));
@@ -421,8 +516,8 @@ uint64_t spmd_smc_handler(uint32_t smc_fid,
 			  void *handle,
 			  uint64_t flags)
 {
-	unsigned int linear_id = plat_my_core_pos();
-	spmd_spm_core_context_t *ctx = spmd_get_context();
+	unsigned int linear_id;
+	spmd_spm_core_context_t *ctx;
 	bool secure_origin;
 	int32_t ret;
 	uint32_t input_version;
@@ -430,6 +525,25 @@ uint64_t spmd_smc_handler(uint32_t smc_fid,
 	/* Determine which security state this SMC originated from */
 	secure_origin = is_caller_secure(flags);
 
+	spmd_direct_msg_timestamp(smc_fid, secure_origin, true);
+
+#if SPMD_DIRECT_MSG_FAST_PATH
+	/*
+	 * Direct messages exchanged between the Normal world and the SPM Core
+	 * do not need any of the state looked up below. Messages sent by the
+	 * SPM Core to the SPMD itself are left to the generic dispatch.
+	 */
+	if (spmd_direct_msg_fast_path && spmd_is_direct_msg(smc_fid) &&
+	    !(secure_origin && (GET_SMC_CC(smc_fid) == SMC_32) &&
+	      spmd_is_spmc_message(x1))) {
+		return spmd_smc_forward(smc_fid, secure_origin,
+					x1, x2, x3, x4, handle);
+	}
+#endif
+
+	linear_id = plat_my_core_pos();
+	ctx = spmd_get_context();
+
 	VERBOSE("SPM(%u): 0x%x 0x%llx 0x%llx 0x%llx 0x%llx "
 		"0x%llx 0x%llx 0x%llx\n",
 		linear_id, smc_fid, x1, x2, x3, x4,
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -23,6 +23,9 @@
 #define OPT_PLAT_TOC_FLAGS 1
 #define OPT_ALIGN 2
 
+/* Largest number of threads used to load and hash images. */
+#define MAX_JOBS 64
+
 static int info_cmd(int argc, char *argv[]);
 static void info_usage(int);
 static int create_cmd(int argc, char *argv[]);
@@ -53,6 +56,14 @@ static image_desc_t *image_desc_head;
 static size_t nr_image_descs;
 static const uuid_t uuid_null;
 static int verbose;
+static long nr_jobs;
+
+/* The FIP loaded by parse_fip(), the images it contains point into it. */
+static struct {
+	char                *buf;
+	struct BLD_PLAT_STAT st;
+	int                  buffer_type;
+} fip_file;
 
 static void vlog(int prio, const char *msg, va_list ap)
 {
@@ -134,6 +145,164 @@ static void xfwrite(void *buf, size_t size, FILE *fp, const char *filename)
 		log_errx("Failed to write %s", filename);
 }
 
+/*
+ * Load a whole file into memory. Where possible the file is mapped rather
+ * than read, so that only the pages that are used are ever read and large
+ * images are written out straight from the page cache.
+ */
+static void *load_file(const char *filename, struct BLD_PLAT_STAT *st,
+    int *buffer_type)
+{
+	FILE *fp;
+	void *buf;
+
+	fp = fopen(filename, "rb");
+	if (fp == NULL)
+		log_err("fopen %s", filename);
+
+	if (fstat(fileno(fp), st) == -1)
+		log_err("fstat %s", filename);
+
+#ifndef _MSC_VER
+	if (st->st_size > 0) {
+		buf = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE,
+		    fileno(fp), 0);
+		if (buf != MAP_FAILED) {
+			fclose(fp);
+			*buffer_type = IMAGE_BUF_MMAP;
+			return buf;
+		}
+	}
+#endif
+	buf = xmalloc(st->st_size, "failed to load file into memory");
+	if (fread(buf, 1, st->st_size, fp) != st->st_size)
+		log_errx("Failed to read %s", filename);
+	fclose(fp);
+	*buffer_type = IMAGE_BUF_MALLOC;
+	return buf;
+}
+
+static void unload_file(void *buf, size_t size, int buffer_type)
+{
+#ifndef _MSC_VER
+	if (buffer_type == IMAGE_BUF_MMAP) {
+		munmap(buf, size);
+		return;
+	}
+#endif
+	free(buf);
+}
+
+static void free_image(image_t *image)
+{
+	if (image->buffer_type != IMAGE_BUF_FIP)
+		unload_file(image->buffer, image->toc_e.size,
+		    image->buffer_type);
+	free(image);
+}
+
+/*
+ * Give every image that points into the parsed FIP its own copy of its
+ * data and release the FIP buffer, so that the FIP file can be rewritten.
+ */
+static void detach_fip_images(void)
+{
+	image_desc_t *desc;
+
+	if (fip_file.buf == NULL)
+		return;
+
+	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
+		image_t *image = desc->image;
+		void *buf;
+
+		if (image == NULL || image->buffer_type != IMAGE_BUF_FIP)
+			continue;
+		buf = xmalloc(image->toc_e.size,
+		    "failed to allocate image buffer");
+		memcpy(buf, image->buffer, image->toc_e.size);
+		image->buffer = buf;
+		image->buffer_type = IMAGE_BUF_MALLOC;
+	}
+
+	unload_file(fip_file.buf, fip_file.st.st_size, fip_file.buffer_type);
+	fip_file.buf = NULL;
+}
+
+#ifndef _MSC_VER
+struct job_queue {
+	pthread_mutex_t	  lock;
+	void		(*fn)(void *);
+	char		 *args;
+	size_t		  arg_size;
+	size_t		  nr_args;
+	size_t		  next;
+};
+
+static void *job_worker(void *arg)
+{
+	struct job_queue *q = arg;
+	size_t i;
+
+	while (1) {
+		pthread_mutex_lock(&q->lock);
+		i = q->next;
+		if (i < q->nr_args)
+			q->next++;
+		pthread_mutex_unlock(&q->lock);
+		if (i >= q->nr_args)
+			break;
+		q->fn(q->args + i * q->arg_size);
+	}
+	return NULL;
+}
+#endif
+
+/*
+ * Call fn() on each of the nr_args elements of the args array, spreading the
+ * calls over up to nr_jobs threads. The calls are made in no particular
+ * order and must not depend on each other.
+ */
+static void run_jobs(void (*fn)(void *), void *args, size_t arg_size,
+    size_t nr_args)
+{
+	size_t i;
+#ifndef _MSC_VER
+	pthread_t threads[MAX_JOBS - 1];
+	struct job_queue q = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.fn = fn,
+		.args = args,
+		.arg_size = arg_size,
+		.nr_args = nr_args,
+		.next = 0
+	};
+	size_t nr_threads = 0;
+	long jobs = nr_jobs;
+
+	if (jobs <= 0)
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (jobs < 1)
+		jobs = 1;
+	else if (jobs > MAX_JOBS)
+		jobs = MAX_JOBS;
+
+	/* The calling thread is one of the workers. */
+	while (nr_threads + 1 < (size_t)jobs && nr_threads + 1 < nr_args) {
+		if (pthread_create(&threads[nr_threads], NULL, job_worker,
+		    &q) != 0)
+			break;
+		nr_threads++;
+	}
+	job_worker(&q);
+	for (i = 0; i < nr_threads; i++)
+		pthread_join(threads[i], NULL);
+#else
+	for (i = 0; i < nr_args; i++)
+		fn((char *)args + i * arg_size);
+#endif
+}
+
 static image_desc_t *new_image_desc(const uuid_t *uuid,
     const char *name, const char *cmdline_name)
 {
@@ -169,10 +338,8 @@ static void free_image_desc(image_desc_t *desc)
 	free(desc->name);
 	free(desc->cmdline_name);
 	free(desc->action_arg);
-	if (desc->image) {
-		free(desc->image->buffer);
-		free(desc->image);
-	}
+	if (desc->image)
+		free_image(desc->image);
 	free(desc);
 }
 
@@ -290,27 +457,24 @@ static void uuid_from_str(uuid_t *u, const char *s)
 		log_errx("Invalid UUID: %s", s);
 }
 
+/*
+ * Parse a FIP and attach its images to their descriptors. The images point
+ * into the FIP buffer rather than holding a copy of their data.
+ */
 static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 {
 	struct BLD_PLAT_STAT st;
-	FILE *fp;
 	char *buf, *bufend;
 	fip_toc_header_t *toc_header;
 	fip_toc_entry_t *toc_entry;
 	int terminated = 0;
 
-	fp = fopen(filename, "rb");
-	if (fp == NULL)
-		log_err("fopen %s", filename);
+	assert(fip_file.buf == NULL);
 
-	if (fstat(fileno(fp), &st) == -1)
-		log_err("fstat %s", filename);
-
-	buf = xmalloc(st.st_size, "failed to load file into memory");
-	if (fread(buf, 1, st.st_size, fp) != st.st_size)
-		log_errx("Failed to read %s", filename);
+	buf = load_file(filename, &st, &fip_file.buffer_type);
 	bufend = buf + st.st_size;
-	fclose(fp);
+	fip_file.buf = buf;
+	fip_file.st = st;
 
 	if (st.st_size < sizeof(fip_toc_header_t))
 		log_errx("FIP %s is truncated", filename);
@@ -343,16 +507,14 @@ static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 		image = xzalloc(sizeof(*image),
 		    "failed to allocate memory for image");
 		image->toc_e = *toc_entry;
-		image->buffer = xmalloc(toc_entry->size,
-		    "failed to allocate image buffer, is FIP file corrupted?");
-		/* Overflow checks before memory copy. */
+		/* Overflow checks before pointing into the FIP. */
 		if (toc_entry->size > (uint64_t)-1 - toc_entry->offset_address)
 			log_errx("FIP %s is corrupted", filename);
 		if (toc_entry->size + toc_entry->offset_address > st.st_size)
 			log_errx("FIP %s is corrupted", filename);
 
-		memcpy(image->buffer, buf + toc_entry->offset_address,
-		    toc_entry->size);
+		image->buffer = buf + toc_entry->offset_address;
+		image->buffer_type = IMAGE_BUF_FIP;
 
 		/* If this is an unknown image, create a descriptor for it. */
 		desc = lookup_image_desc_from_uuid(&toc_entry->uuid);
@@ -378,7 +540,6 @@ static int parse_fip(const char *filename, fip_toc_header_t *toc_header_out)
 	if (terminated == 0)
 		log_errx("FIP %s does not have a ToC terminator entry",
 		    filename);
-	free(buf);
 	return 0;
 }
 
@@ -386,26 +547,19 @@ static image_t *read_image_from_file(const uuid_t *uuid, const char *filename)
 {
 	struct BLD_PLAT_STAT st;
 	image_t *image;
-	FILE *fp;
 
 	assert(uuid != NULL);
 	assert(filename != NULL);
 
-	fp = fopen(filename, "rb");
-	if (fp == NULL)
-		log_err("fopen %s", filename);
-
-	if (fstat(fileno(fp), &st) == -1)
-		log_errx("fstat %s", filename);
-
 	image = xzalloc(sizeof(*image), "failed to allocate memory for image");
 	image->toc_e.uuid = *uuid;
-	image->buffer = xmalloc(st.st_size, "failed to allocate image buffer");
-	if (fread(image->buffer, 1, st.st_size, fp) != st.st_size)
-		log_errx("Failed to read %s", filename);
+	image->buffer = load_file(filename, &st, &image->buffer_type);
 	image->toc_e.size = st.st_size;
-
-	fclose(fp);
+#ifndef _MSC_VER
+	/* The whole image is going to be written out, start reading it. */
+	if (image->buffer_type == IMAGE_BUF_MMAP)
+		posix_madvise(image->buffer, st.st_size, POSIX_MADV_WILLNEED);
+#endif
 	return image;
 }
 
@@ -454,10 +608,28 @@ static void md_print(const unsigned char *md, size_t len)
 		printf("%02x", md[i]);
 }
 
+#ifndef _MSC_VER	/* We don't have SHA256 for Visual Studio. */
+struct hash_job {
+	const image_t *image;
+	unsigned char  md[SHA256_DIGEST_LENGTH];
+};
+
+static void hash_image_job(void *arg)
+{
+	struct hash_job *job = arg;
+
+	SHA256(job->image->buffer, job->image->toc_e.size, job->md);
+}
+#endif
+
 static int info_cmd(int argc, char *argv[])
 {
 	image_desc_t *desc;
 	fip_toc_header_t toc_header;
+#ifndef _MSC_VER
+	struct hash_job *jobs = NULL;
+	size_t nr_hash_jobs = 0;
+#endif
 
 	if (argc != 2)
 		info_usage(EXIT_FAILURE);
@@ -474,6 +646,19 @@ static int info_cmd(int argc, char *argv[])
 		    (unsigned long long)toc_header.flags);
 	}
 
+#ifndef _MSC_VER
+	/* Hash all the images up front, in parallel. */
+	if (verbose) {
+		jobs = xzalloc(nr_image_descs * sizeof(*jobs),
+		    "failed to allocate memory for hash jobs");
+		for (desc = image_desc_head; desc != NULL; desc = desc->next)
+			if (desc->image != NULL)
+				jobs[nr_hash_jobs++].image = desc->image;
+		run_jobs(hash_image_job, jobs, sizeof(*jobs), nr_hash_jobs);
+		nr_hash_jobs = 0;
+	}
+#endif
+
 	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
 		image_t *image = desc->image;
 
@@ -486,16 +671,18 @@ static int info_cmd(int argc, char *argv[])
 		       desc->cmdline_name);
 #ifndef _MSC_VER	/* We don't have SHA256 for Visual Studio. */
 		if (verbose) {
-			unsigned char md[SHA256_DIGEST_LENGTH];
-
-			SHA256(image->buffer, image->toc_e.size, md);
 			printf(", sha256=");
-			md_print(md, sizeof(md));
+			md_print(jobs[nr_hash_jobs].md,
+			    sizeof(jobs[nr_hash_jobs].md));
+			nr_hash_jobs++;
 		}
 #endif
 		putchar('\n');
 	}
 
+#ifndef _MSC_VER
+	free(jobs);
+#endif
 	return 0;
 }
 
@@ -505,6 +692,17 @@ static void info_usage(int exit_status)
 	exit(exit_status);
 }
 
+/* Return whether filename names the FIP that has been parsed. */
+static int is_fip_file(const char *filename)
+{
+	struct BLD_PLAT_STAT st;
+
+	if (stat(filename, &st) == -1)
+		return 0;
+	return st.st_dev == fip_file.st.st_dev &&
+	    st.st_ino == fip_file.st.st_ino;
+}
+
 static int pack_images(const char *filename, uint64_t toc_flags, unsigned long align)
 {
 	FILE *fp;
@@ -554,6 +752,13 @@ static int pack_images(const char *filename, uint64_t toc_flags, unsigned long a
 	memset(toc_entry, 0, sizeof(*toc_entry));
 	toc_entry->offset_address = (entry_offset + align - 1) & ~(align - 1);
 
+	/*
+	 * Opening the FIP truncates it, make sure that no image still points
+	 * into it if it is the FIP that has been parsed.
+	 */
+	if (fip_file.buf != NULL && is_fip_file(filename))
+		detach_fip_images();
+
 	/* Generate the FIP file. */
 	fp = fopen(filename, "wb");
 	if (fp == NULL)
@@ -597,26 +802,45 @@ static int pack_images(const char *filename, uint64_t toc_flags, unsigned long a
  * in update_fip() creating the new FIP file from scratch because the
  * internal image table is not populated.
  */
+struct load_job {
+	image_desc_t *desc;
+	image_t      *image;
+};
+
+static void load_image_job(void *arg)
+{
+	struct load_job *job = arg;
+
+	job->image = read_image_from_file(&job->desc->uuid,
+	    job->desc->action_arg);
+}
+
 static void update_fip(void)
 {
 	image_desc_t *desc;
+	struct load_job *jobs;
+	size_t i, nr_load_jobs = 0;
 
-	/* Add or replace images in the FIP file. */
-	for (desc = image_desc_head; desc != NULL; desc = desc->next) {
-		image_t *image;
+	/* Load the new images in parallel. */
+	jobs = xzalloc(nr_image_descs * sizeof(*jobs),
+	    "failed to allocate memory for load jobs");
+	for (desc = image_desc_head; desc != NULL; desc = desc->next)
+		if (desc->action == DO_PACK)
+			jobs[nr_load_jobs++].desc = desc;
+	run_jobs(load_image_job, jobs, sizeof(*jobs), nr_load_jobs);
 
-		if (desc->action != DO_PACK)
-			continue;
+	/* Add or replace images in the FIP file. */
+	for (i = 0; i < nr_load_jobs; i++) {
+		image_t *image = jobs[i].image;
 
-		image = read_image_from_file(&desc->uuid,
-		    desc->action_arg);
+		desc = jobs[i].desc;
 		if (desc->image != NULL) {
 			if (verbose) {
 				log_dbgx("Replacing %s with %s",
 				    desc->cmdline_name,
 				    desc->action_arg);
 			}
-			free(desc->image);
+			free_image(desc->image);
 			desc->image = image;
 		} else {
 			if (verbose)
@@ -625,6 +849,138 @@ static void update_fip(void)
 			desc->image = image;
 		}
 	}
+	free(jobs);
+}
+
+static int ranges_overlap(uint64_t a_start, uint64_t a_end,
+    uint64_t b_start, uint64_t b_end)
+{
+	return a_start < b_end && b_start < a_end;
+}
+
+/*
+ * Update the parsed FIP in place, rewriting only its ToC and the payloads of
+ * the images that have been replaced. This is only possible when no image is
+ * added, every new payload fits in the space used by the image it replaces
+ * without running into another image and all the images are already aligned
+ * to 'align'. The space left over by a smaller payload is zeroed. Returns 0
+ * on success, or -1 without having modified the file if the FIP must be
+ * repacked instead.
+ */
+static int pack_images_in_place(const char *filename, uint64_t toc_flags,
+    unsigned long align)
+{
+	static char zeros[4096];
+	fip_toc_header_t toc_header;
+	fip_toc_entry_t *toc, *toc_entry;
+	image_desc_t *desc;
+	uint64_t *end, toc_end;
+	size_t i, j, nr_entries = 0, nr_packed = 0, nr_replaced = 0;
+	int ret = -1;
+	FILE *fp;
+
+	if (fip_file.buf == NULL)
+		return -1;
+
+	for (desc = image_desc_head; desc != NULL; desc = desc->next)
+		if (desc->action == DO_PACK)
+			nr_packed++;
+
+	/*
+	 * Take a copy of the ToC, as it may not be read back from the FIP
+	 * buffer once the file has been written to. parse_fip() has checked
+	 * that it is terminated and that the entries lie within the file.
+	 */
+	toc_header = *(fip_toc_header_t *)fip_file.buf;
+	toc_entry = (fip_toc_entry_t *)(fip_file.buf + sizeof(toc_header));
+	while (memcmp(&toc_entry[nr_entries].uuid, &uuid_null,
+	    sizeof(uuid_t)) != 0)
+		nr_entries++;
+	toc_end = sizeof(toc_header) + (nr_entries + 1) * sizeof(*toc_entry);
+
+	toc = xmalloc((nr_entries + 1) * sizeof(*toc),
+	    "failed to allocate memory for ToC");
+	memcpy(toc, toc_entry, (nr_entries + 1) * sizeof(*toc));
+	end = xmalloc((nr_entries + 1) * sizeof(*end),
+	    "failed to allocate memory for ToC");
+
+	/* Work out the space each image occupies once updated. */
+	for (i = 0; i < nr_entries; i++) {
+		uint64_t size = toc[i].size;
+
+		if (toc[i].offset_address % align != 0)
+			goto out;
+
+		desc = lookup_image_desc_from_uuid(&toc[i].uuid);
+		if (desc != NULL && desc->action == DO_PACK) {
+			image_t *image = desc->image;
+
+			if (image->toc_e.size > (uint64_t)fip_file.st.st_size -
+			    toc[i].offset_address)
+				goto out;
+			if (image->toc_e.size > size)
+				size = image->toc_e.size;
+			toc[i].size = image->toc_e.size;
+			toc[i].flags = image->toc_e.flags;
+			nr_replaced++;
+		}
+		end[i] = toc[i].offset_address + size;
+	}
+
+	/* An image that is not in the FIP yet needs a new ToC entry. */
+	if (nr_replaced != nr_packed)
+		goto out;
+
+	/* Check that the new payloads do not run into anything else. */
+	for (i = 0; i < nr_entries; i++) {
+		desc = lookup_image_desc_from_uuid(&toc[i].uuid);
+		if (desc == NULL || desc->action != DO_PACK)
+			continue;
+		if (ranges_overlap(toc[i].offset_address, end[i], 0, toc_end))
+			goto out;
+		for (j = 0; j < nr_entries; j++)
+			if (j != i && ranges_overlap(toc[i].offset_address,
+			    end[i], toc[j].offset_address, end[j]))
+				goto out;
+	}
+
+	fp = fopen(filename, "r+b");
+	if (fp == NULL)
+		log_err("fopen %s", filename);
+
+	if (verbose)
+		log_dbgx("Updating %s in place", filename);
+
+	toc_header.flags = toc_flags;
+	xfwrite(&toc_header, sizeof(toc_header), fp, filename);
+	xfwrite(toc, nr_entries * sizeof(*toc), fp, filename);
+
+	for (i = 0; i < nr_entries; i++) {
+		uint64_t pad_size;
+
+		desc = lookup_image_desc_from_uuid(&toc[i].uuid);
+		if (desc == NULL || desc->action != DO_PACK)
+			continue;
+		if (fseek(fp, toc[i].offset_address, SEEK_SET))
+			log_errx("Failed to set file position");
+		xfwrite(desc->image->buffer, toc[i].size, fp, filename);
+
+		pad_size = end[i] - toc[i].offset_address - toc[i].size;
+		while (pad_size > 0) {
+			size_t n = pad_size < sizeof(zeros) ?
+			    pad_size : sizeof(zeros);
+
+			xfwrite(zeros, n, fp, filename);
+			pad_size -= n;
+		}
+	}
+
+	fclose(fp);
+	ret = 0;
+out:
+	free(end);
+	free(toc);
+	return ret;
 }
 
 static void parse_plat_toc_flags(const char *arg, unsigned long long *toc_flags)
@@ -865,7 +1221,9 @@ static int update_cmd(int argc, char *argv[])
 
 	update_fip();
 
-	pack_images(outfile, toc_flags, align);
+	if (strcmp(outfile, argv[0]) != 0 ||
+	    pack_images_in_place(outfile, toc_flags, align) != 0)
+		pack_images(outfile, toc_flags, align);
 	return 0;
 }
 
@@ -881,6 +1239,8 @@ static void update_usage(int exit_status)
 	printf("  --out FIP_FILENAME\t\tSet an alternative output FIP file.\n");
 	printf("  --plat-toc-flags <value>\t16-bit platform specific flag field occupying bits 32-47 in 64-bit ToC header.\n");
 	printf("\n");
+	printf("Without --out, the FIP is updated in place when the new images fit in the space of the ones they replace.\n");
+	printf("\n");
 	printf("Specific images are packed with the following options:\n");
 	for (; toc_entry->cmdline_name != NULL; toc_entry++)
 		printf("  --%-16s FILENAME\t%s\n", toc_entry->cmdline_name,
@@ -1128,7 +1488,7 @@ static int remove_cmd(int argc, char *argv[])
 			if (verbose)
 				log_dbgx("Removing %s",
 				    desc->cmdline_name);
-			free(desc->image);
+			free_image(desc->image);
 			desc->image = NULL;
 		} else {
 			log_warnx("%s does not exist in %s",
@@ -1202,8 +1562,9 @@ static int help_cmd(int argc, char *argv[])
 
 static void usage(void)
 {
-	printf("usage: fiptool [--verbose] <command> [<args>]\n");
+	printf("usage: fiptool [--verbose] [--jobs N] <command> [<args>]\n");
 	printf("Global options supported:\n");
+	printf("  --jobs N\tLoad and hash images with up to N threads (default: number of CPUs).\n");
 	printf("  --verbose\tEnable verbose output for all commands.\n");
 	printf("\n");
 	printf("Commands supported:\n");
@@ -1224,6 +1585,7 @@ int main(int argc, char *argv[])
 	while (1) {
 		int c, opt_index = 0;
 		static struct option opts[] = {
+			{ "jobs", required_argument, NULL, 'j' },
 			{ "verbose", no_argument, NULL, 'v' },
 			{ NULL, no_argument, NULL, 0 }
 		};
@@ -1232,11 +1594,20 @@ int main(int argc, char *argv[])
 		 * Set POSIX mode so getopt stops at the first non-option
 		 * which is the subcommand.
 		 */
-		c = getopt_long(argc, argv, "+v", opts, &opt_index);
+		c = getopt_long(argc, argv, "+j:v", opts, &opt_index);
 		if (c == -1)
 			break;
 
 		switch (c) {
+		case 'j': {
+			char *endptr;
+
+			errno = 0;
+			nr_jobs = strtol(optarg, &endptr, 0);
+			if (*endptr != '\0' || nr_jobs <= 0 || errno != 0)
+				log_errx("Invalid number of jobs: %s", optarg);
+			break;
+		}
 		case 'v':
 			verbose = 1;
 			break;
@@ -1262,5 +1633,8 @@ int main(int argc, char *argv[])
 	if (i == NELEM(cmds))
 		usage();
 	free_image_descs();
+	if (fip_file.buf != NULL)
+		unload_file(fip_file.buf, fip_file.st.st_size,
+		    fip_file.buffer_type);
 	return ret;
 }
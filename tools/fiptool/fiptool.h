@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2021, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -24,6 +24,13 @@ enum {
 	DO_REMOVE = 3
 };
 
+/* Where the data of an image is held. */
+enum {
+	IMAGE_BUF_MALLOC = 0,	/* Heap buffer owned by the image */
+	IMAGE_BUF_MMAP   = 1,	/* Mapping of the image file owned by the image */
+	IMAGE_BUF_FIP    = 2	/* Points into the buffer of the parsed FIP */
+};
+
 enum {
 	LOG_DBG,
 	LOG_WARN,
@@ -43,6 +50,7 @@ typedef struct image_desc {
 typedef struct image {
 	struct fip_toc_entry toc_e;
 	void                *buffer;
+	int                  buffer_type;
 } image_t;
 
 typedef struct cmd {
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2021, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host benchmark of the inflate() used by TF gunzip(). Each .gz image given on
+ * the command line is decompressed with the imported inffast.c and with
+ * tf_inffast.c, the outputs are checked against each other and the throughput
+ * of both is reported.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zutil.h"
+
+#define DEFAULT_ITERATIONS	20
+
+typedef void (*inflate_fast_fn)(z_streamp strm, unsigned start);
+
+void ZLIB_INTERNAL ref_inflate_fast(z_streamp strm, unsigned start);
+void ZLIB_INTERNAL tf_inflate_fast(z_streamp strm, unsigned start);
+
+static const struct {
+	const char *name;
+	inflate_fast_fn fn;
+} variants[] = {
+	{ "inffast.c", ref_inflate_fast },
+	{ "tf_inffast.c", tf_inflate_fast },
+};
+
+#define NUM_VARIANTS	(sizeof(variants) / sizeof(variants[0]))
+
+static inflate_fast_fn cur_inflate_fast;
+
+/* Called by inflate.c, in place of the one inflate_fast() of a TF build */
+void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start)
+{
+	cur_inflate_fast(strm, start);
+}
+
+static void log_err(const char *msg, ...)
+{
+	va_list ap;
+
+	va_start(ap, msg);
+	fputs("ERROR: ", stderr);
+	vfprintf(stderr, msg, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+}
+
+static voidpf bench_zalloc(voidpf opaque, uInt items, uInt size)
+{
+	return calloc(items, size);
+}
+
+static void bench_zfree(voidpf opaque, voidpf ptr)
+{
+	free(ptr);
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static unsigned char *read_file(const char *path, size_t *len)
+{
+	FILE *fp;
+	unsigned char *buf;
+	long size;
+
+	fp = fopen(path, "rb");
+	if (fp == NULL) {
+		log_err("fopen %s: %s", path, strerror(errno));
+		return NULL;
+	}
+
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 ||
+	    fseek(fp, 0, SEEK_SET) != 0) {
+		log_err("failed to get the size of %s", path);
+		fclose(fp);
+		return NULL;
+	}
+
+	buf = malloc(size);
+	if (buf == NULL) {
+		log_err("malloc: %s", strerror(errno));
+		fclose(fp);
+		return NULL;
+	}
+
+	if (fread(buf, 1, size, fp) != (size_t)size) {
+		log_err("failed to read %s", path);
+		free(buf);
+		fclose(fp);
+		return NULL;
+	}
+
+	fclose(fp);
+	*len = size;
+	return buf;
+}
+
+/* Decompress a whole gzip image in one inflate() call, as gunzip() does */
+static int gunzip_once(const unsigned char *in, size_t in_len,
+		       unsigned char *out, size_t out_len, size_t *out_used)
+{
+	z_stream stream;
+	int zret;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.zalloc = bench_zalloc;
+	stream.zfree = bench_zfree;
+
+	zret = inflateInit(&stream);
+	if (zret != Z_OK)
+		return zret;
+
+	stream.next_in = (z_const Bytef *)in;
+	stream.avail_in = in_len;
+	stream.next_out = out;
+	stream.avail_out = out_len;
+
+	zret = inflate(&stream, Z_FINISH);
+	*out_used = out_len - stream.avail_out;
+	inflateEnd(&stream);
+
+	return (zret == Z_STREAM_END) ? Z_OK : zret;
+}
+
+static int bench_file(const char *path, unsigned int iterations)
+{
+	unsigned char *in, *out[NUM_VARIANTS] = { NULL };
+	size_t in_len, out_len, used;
+	double mbps[NUM_VARIANTS];
+	unsigned int i, n;
+	int ret = -1;
+
+	in = read_file(path, &in_len);
+	if (in == NULL)
+		return -1;
+
+	if (in_len < 18) {
+		log_err("%s: not a gzip image", path);
+		goto out;
+	}
+
+	/* ISIZE, the last field of the gzip trailer */
+	out_len = in[in_len - 4] | (in[in_len - 3] << 8) |
+		  (in[in_len - 2] << 16) | ((size_t)in[in_len - 1] << 24);
+
+	for (i = 0U; i < NUM_VARIANTS; i++) {
+		double start;
+		int zret;
+
+		/* One spare byte to catch an image longer than ISIZE */
+		out[i] = malloc(out_len + 1);
+		if (out[i] == NULL) {
+			log_err("malloc: %s", strerror(errno));
+			goto out;
+		}
+
+		cur_inflate_fast = variants[i].fn;
+		start = now();
+		for (n = 0U; n < iterations; n++) {
+			zret = gunzip_once(in, in_len, out[i], out_len + 1,
+					   &used);
+			if (zret != Z_OK || used != out_len) {
+				log_err("%s: %s: inflate failed (ret = %d)",
+					path, variants[i].name, zret);
+				goto out;
+			}
+		}
+		mbps[i] = (double)out_len * iterations /
+			  (now() - start) / 1e6;
+	}
+
+	for (i = 1U; i < NUM_VARIANTS; i++) {
+		if (memcmp(out[0], out[i], out_len) != 0) {
+			log_err("%s: %s and %s outputs differ", path,
+				variants[0].name, variants[i].name);
+			goto out;
+		}
+	}
+
+	printf("%s: %zu -> %zu bytes\n", path, in_len, out_len);
+	for (i = 0U; i < NUM_VARIANTS; i++)
+		printf("  %-14s %9.1f MB/s\n", variants[i].name, mbps[i]);
+	printf("  %-14s %9.2fx\n", "speedup", mbps[NUM_VARIANTS - 1] / mbps[0]);
+	ret = 0;
+
+out:
+	for (i = 0U; i < NUM_VARIANTS; i++)
+		free(out[i]);
+	free(in);
+	return ret;
+}
+
+static void usage(void)
+{
+	printf("zlib_bench [-n iterations] FILE.gz...\n\n");
+	printf("Decompress each gzip image with the imported inffast.c and with\n");
+	printf("tf_inffast.c, check that the outputs match and print the\n");
+	printf("throughput of both, in MB of output per second.\n\n");
+	printf("  -n iterations\tDecompress each image this many times (default %d)\n",
+	       DEFAULT_ITERATIONS);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int iterations = DEFAULT_ITERATIONS;
+	int c, ret = 0;
+
+	while ((c = getopt(argc, argv, "hn:")) != -1) {
+		switch (c) {
+		case 'n':
+			iterations = strtoul(optarg, NULL, 0);
+			if (iterations == 0U) {
+				log_err("invalid iteration count: %s", optarg);
+				return 1;
+			}
+			break;
+		case 'h':
+			usage();
+			return 0;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (optind == argc) {
+		usage();
+		return 1;
+	}
+
+	for (; optind < argc; optind++) {
+		if (bench_file(argv[optind], iterations) != 0)
+			ret = 1;
+	}
+
+	return ret;
+}